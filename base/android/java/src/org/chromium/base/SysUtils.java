@@ -6,10 +6,12 @@ package org.chromium.base;
 
 import android.annotation.TargetApi;
 import android.app.ActivityManager;
+import android.content.ComponentCallbacks2;
 import android.content.Context;
 import android.content.pm.PackageInfo;
 import android.content.pm.PackageManager.NameNotFoundException;
 import android.content.pm.PackageManager;
+import android.content.res.Configuration;
 import android.os.Build;
 import android.os.Environment;
 import android.os.StatFs;
@@ -43,6 +45,9 @@ public class SysUtils {
     // A device reporting more disk capacity in gigabytes than this is considered high end.
     private static final long HIGH_END_DEVICE_DISK_CAPACITY_GB = 24;
 
+    // How often ActivityManager is asked whether memory recovered, while it is low.
+    private static final long LOW_MEMORY_REFRESH_INTERVAL_MS = 10000;
+
     private static final String TAG = "SysUtils";
 
     private static Boolean sLowEndDevice;
@@ -50,6 +55,9 @@ public class SysUtils {
 
     private static Boolean sHighEndDiskDevice;
 
+    private static ComponentCallbacks2 sMemoryStateCallbacks;
+    private static boolean sLowMemoryRefreshPending;
+
     private SysUtils() { }
 
     /**
@@ -172,6 +180,64 @@ public class SysUtils {
         return info.lowMemory;
     }
 
+    /**
+     * Starts telling native when the system runs low on memory and when it recovers, and returns
+     * whether it currently does. Native caches the state so it does not have to ask
+     * ActivityManager on every call.
+     */
+    @CalledByNative
+    private static boolean startMemoryStateUpdates() {
+        ThreadUtils.runOnUiThread(() -> {
+            if (sMemoryStateCallbacks != null) return;
+            sMemoryStateCallbacks = new ComponentCallbacks2() {
+                @Override
+                public void onTrimMemory(int level) {
+                    // The other levels are about this app's place in the background LRU list,
+                    // not about the memory left on the system.
+                    if (level == TRIM_MEMORY_RUNNING_LOW
+                            || level == TRIM_MEMORY_RUNNING_CRITICAL) {
+                        onSystemLowMemory();
+                    }
+                }
+
+                @Override
+                public void onLowMemory() {
+                    onSystemLowMemory();
+                }
+
+                @Override
+                public void onConfigurationChanged(Configuration configuration) {}
+            };
+            ContextUtils.getApplicationContext().registerComponentCallbacks(
+                    sMemoryStateCallbacks);
+            if (isCurrentlyLowMemory()) scheduleLowMemoryRefresh();
+        });
+        return isCurrentlyLowMemory();
+    }
+
+    private static void onSystemLowMemory() {
+        SysUtilsJni.get().onMemoryStateChanged(true);
+        scheduleLowMemoryRefresh();
+    }
+
+    /**
+     * Android sends no signal when memory recovers, so while it is low ActivityManager is asked
+     * again every LOW_MEMORY_REFRESH_INTERVAL_MS, and native is told once it no longer is.
+     */
+    private static void scheduleLowMemoryRefresh() {
+        ThreadUtils.assertOnUiThread();
+        if (sLowMemoryRefreshPending) return;
+        sLowMemoryRefreshPending = true;
+        ThreadUtils.postOnUiThreadDelayed(() -> {
+            sLowMemoryRefreshPending = false;
+            if (isCurrentlyLowMemory()) {
+                scheduleLowMemoryRefresh();
+            } else {
+                SysUtilsJni.get().onMemoryStateChanged(false);
+            }
+        }, LOW_MEMORY_REFRESH_INTERVAL_MS);
+    }
+
     /**
      * Resets the cached value, if any.
      */
@@ -268,5 +334,6 @@ public class SysUtils {
     @NativeMethods
     interface Natives {
         void logPageFaultCountToTracing();
+        void onMemoryStateChanged(boolean isLowMemory);
     }
 }
@@ -4,18 +4,72 @@
 
 #include "base/android/sys_utils.h"
 
+#include <atomic>
 #include <memory>
 
 #include "base/android/build_info.h"
 #include "base/base_jni_headers/SysUtils_jni.h"
+#include "base/no_destructor.h"
+#include "base/observer_list_threadsafe.h"
 #include "base/process/process_metrics.h"
 #include "base/system/sys_info.h"
+#include "base/time/time.h"
 #include "base/trace_event/base_tracing.h"
 #include "base/android/jni_string.h"
 
 namespace base {
 namespace android {
 
+namespace {
+
+// SysUtils.java tells when memory runs low and, by asking ActivityManager
+// periodically while it is, when it recovers. The cached state is also
+// refreshed by IsCurrentlyLowMemory() once it is this old, in case a signal
+// was missed.
+constexpr TimeDelta kMemoryStateRefreshInterval = TimeDelta::FromSeconds(10);
+
+enum MemoryStateValue : int {
+  kMemoryStateUnknown,
+  kMemoryStateNormal,
+  kMemoryStateLow,
+};
+
+struct MemoryState {
+  std::atomic<int> value{kMemoryStateUnknown};
+  // TimeTicks of the last update, in microseconds.
+  std::atomic<int64_t> updated_at_us{0};
+  std::atomic<bool> updates_started{false};
+  std::atomic<int> physical_memory_kb{-1};
+  const scoped_refptr<ObserverListThreadSafe<SysUtils::MemoryStateObserver>>
+      observers = MakeRefCounted<
+          ObserverListThreadSafe<SysUtils::MemoryStateObserver>>();
+};
+
+MemoryState& GetMemoryState() {
+  static NoDestructor<MemoryState> state;
+  return *state;
+}
+
+int64_t NowInMicroseconds() {
+  return (TimeTicks::Now() - TimeTicks()).InMicroseconds();
+}
+
+void SetLowMemory(bool is_low_memory) {
+  MemoryState& state = GetMemoryState();
+  const int value = is_low_memory ? kMemoryStateLow : kMemoryStateNormal;
+  state.updated_at_us.store(NowInMicroseconds(), std::memory_order_relaxed);
+  const int old_value = state.value.exchange(value);
+  // Starting out in the normal state is not a change.
+  if (old_value != value &&
+      (old_value != kMemoryStateUnknown || is_low_memory)) {
+    state.observers->Notify(
+        FROM_HERE, &SysUtils::MemoryStateObserver::OnMemoryStateChanged,
+        is_low_memory);
+  }
+}
+
+}  // namespace
+
 long SysUtils::FirstInstallDateFromJni() {
   JNIEnv* env = AttachCurrentThread();
   return Java_SysUtils_firstInstallDate(env);
@@ -37,14 +91,50 @@ bool SysUtils::IsLowEndDeviceFromJni() {
 }
 
 bool SysUtils::IsCurrentlyLowMemory() {
-  JNIEnv* env = AttachCurrentThread();
-  return Java_SysUtils_isCurrentlyLowMemory(env);
+  MemoryState& state = GetMemoryState();
+  if (!state.updates_started.exchange(true)) {
+    JNIEnv* env = AttachCurrentThread();
+    SetLowMemory(Java_SysUtils_startMemoryStateUpdates(env));
+  } else if (state.value.load() == kMemoryStateUnknown ||
+             NowInMicroseconds() -
+                     state.updated_at_us.load(std::memory_order_relaxed) >=
+                 kMemoryStateRefreshInterval.InMicroseconds()) {
+    JNIEnv* env = AttachCurrentThread();
+    SetLowMemory(Java_SysUtils_isCurrentlyLowMemory(env));
+  }
+  return state.value.load() == kMemoryStateLow;
 }
 
 // static
 int SysUtils::AmountOfPhysicalMemoryKB() {
-  JNIEnv* env = AttachCurrentThread();
-  return Java_SysUtils_amountOfPhysicalMemoryKB(env);
+  // The amount of memory does not change while the process runs.
+  MemoryState& state = GetMemoryState();
+  int physical_memory_kb =
+      state.physical_memory_kb.load(std::memory_order_relaxed);
+  if (physical_memory_kb < 0) {
+    JNIEnv* env = AttachCurrentThread();
+    physical_memory_kb = Java_SysUtils_amountOfPhysicalMemoryKB(env);
+    state.physical_memory_kb.store(physical_memory_kb,
+                                   std::memory_order_relaxed);
+  }
+  return physical_memory_kb;
+}
+
+// static
+void SysUtils::AddMemoryStateObserver(MemoryStateObserver* observer) {
+  GetMemoryState().observers->AddObserver(observer);
+  // Makes sure the trim memory callbacks are registered.
+  IsCurrentlyLowMemory();
+}
+
+// static
+void SysUtils::RemoveMemoryStateObserver(MemoryStateObserver* observer) {
+  GetMemoryState().observers->RemoveObserver(observer);
+}
+
+static void JNI_SysUtils_OnMemoryStateChanged(JNIEnv* env,
+                                              jboolean is_low_memory) {
+  SetLowMemory(is_low_memory);
 }
 
 // Logs the number of minor / major page faults to tracing (and also the time to
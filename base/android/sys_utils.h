@@ -12,15 +12,31 @@ namespace android {
 
 class BASE_EXPORT SysUtils {
  public:
+  // Told when the system enters or leaves the low memory state, on the
+  // sequence the observer was added on.
+  class MemoryStateObserver {
+   public:
+    virtual void OnMemoryStateChanged(bool is_low_memory) = 0;
+
+   protected:
+    virtual ~MemoryStateObserver() = default;
+  };
+
   static long FirstInstallDateFromJni();
   static std::string ReferrerStringFromJni();
   static std::string NightModeSettingsFromJni();
   // Returns true iff this is a low-end device.
   static bool IsLowEndDeviceFromJni();
-  // Returns true if system has low available memory.
+  // Returns true if system has low available memory. Cheap and callable from
+  // any thread: the state is cached, set by the onTrimMemory() callbacks and
+  // refreshed from ActivityManager every few seconds while memory is low.
   static bool IsCurrentlyLowMemory();
   // Returns amount of physical ram detected in KB, or 0 if detection failed.
   static int AmountOfPhysicalMemoryKB();
+
+  // Must be called on a sequence, and removed on the same sequence.
+  static void AddMemoryStateObserver(MemoryStateObserver* observer);
+  static void RemoveMemoryStateObserver(MemoryStateObserver* observer);
 };
 
 }  // namespace android
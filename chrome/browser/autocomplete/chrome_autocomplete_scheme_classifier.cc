@@ -4,6 +4,8 @@
 
 #include "chrome/browser/autocomplete/chrome_autocomplete_scheme_classifier.h"
 
+#include "base/containers/fixed_flat_set.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "build/build_config.h"
 #include "chrome/browser/custom_handlers/protocol_handler_registry.h"
@@ -19,6 +21,22 @@
 #include "content/public/common/url_constants.h"
 #include "url/url_util.h"
 
+namespace {
+
+// Schemes that the omnibox navigates to although ProfileIOData does not
+// handle them itself: content::kViewSourceScheme, url::kDataScheme,
+// url::kJavaScriptScheme and our own. Those constants are not constexpr, so
+// they are spelled out. Looked up once, with the scheme lowercased.
+constexpr auto kOmniboxNavigableSchemes =
+    base::MakeFixedFlatSet<base::StringPiece>({
+        "data",
+        "javascript",
+        "kiwi",
+        "view-source",
+    });
+
+}  // namespace
+
 #if defined(OS_ANDROID)
 static jlong
 JNI_ChromeAutocompleteSchemeClassifier_CreateAutocompleteClassifier(
@@ -53,13 +71,12 @@ ChromeAutocompleteSchemeClassifier::GetInputTypeForScheme(
   if (scheme.empty()) {
     return metrics::OmniboxInputType::EMPTY;
   }
-  if (base::IsStringASCII(scheme) &&
-      (ProfileIOData::IsHandledProtocol(scheme) ||
-       base::LowerCaseEqualsASCII(scheme, content::kViewSourceScheme) ||
-       base::LowerCaseEqualsASCII(scheme, url::kJavaScriptScheme) ||
-       base::LowerCaseEqualsASCII(scheme, "kiwi") ||
-       base::LowerCaseEqualsASCII(scheme, url::kDataScheme))) {
-    return metrics::OmniboxInputType::URL;
+  if (base::IsStringASCII(scheme)) {
+    const std::string lower_scheme = base::ToLowerASCII(scheme);
+    if (kOmniboxNavigableSchemes.contains(lower_scheme) ||
+        ProfileIOData::IsHandledProtocol(lower_scheme)) {
+      return metrics::OmniboxInputType::URL;
+    }
   }
 
   // Also check for schemes registered via registerProtocolHandler(), which
@@ -52,6 +52,7 @@
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/base/models/image_model.h"
 #include "ui/base/models/menu_separator_types.h"
+#include "ui/base/models/simple_menu_model.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/gfx/color_palette.h"
 #include "ui/gfx/image/image.h"
@@ -115,6 +116,54 @@ bool IsExtensionRequiredByPolicy(const Extension* extension,
          policy->MustRemainInstalled(extension, nullptr);
 }
 
+// The page access submenu. It also remembers the site access of the extension
+// on the page it was last asked about: building the menu and showing it asks
+// for the same URL several times (once for the submenu, then for the enabled
+// and checked state of each page access item), and every
+// ScriptingPermissionsModifier::GetSiteAccess() call tests the extension's
+// permission patterns again.
+class PageAccessSubmenuModel : public ui::SimpleMenuModel {
+ public:
+  using SimpleMenuModel::SimpleMenuModel;
+
+  ScriptingPermissionsModifier::SiteAccess GetSiteAccess(
+      const ScriptingPermissionsModifier& modifier,
+      const GURL& url) {
+    if (!has_site_access_ || site_access_url_ != url) {
+      site_access_url_ = url;
+      site_access_ = modifier.GetSiteAccess(url);
+      has_site_access_ = true;
+    }
+    return site_access_;
+  }
+
+  void SetSiteAccess(const GURL& url,
+                     const ScriptingPermissionsModifier::SiteAccess& access) {
+    site_access_url_ = url;
+    site_access_ = access;
+    has_site_access_ = true;
+  }
+
+  void ClearSiteAccess() { has_site_access_ = false; }
+
+ private:
+  bool has_site_access_ = false;
+  GURL site_access_url_;
+  ScriptingPermissionsModifier::SiteAccess site_access_;
+};
+
+// Page access commands only exist in the submenu, but the site access is read
+// directly if there is none.
+ScriptingPermissionsModifier::SiteAccess GetSiteAccessForMenu(
+    ui::SimpleMenuModel* page_access_submenu,
+    const ScriptingPermissionsModifier& modifier,
+    const GURL& url) {
+  if (!page_access_submenu)
+    return modifier.GetSiteAccess(url);
+  return static_cast<PageAccessSubmenuModel*>(page_access_submenu)
+      ->GetSiteAccess(modifier, url);
+}
+
 ExtensionContextMenuModel::ContextMenuAction CommandIdToContextMenuAction(
     int command_id) {
   using ContextMenuAction = ExtensionContextMenuModel::ContextMenuAction;
@@ -470,7 +519,8 @@ ExtensionContextMenuModel::GetCurrentPageAccess(
   ScriptingPermissionsModifier modifier(profile_, extension);
   DCHECK(modifier.CanAffectExtension());
   ScriptingPermissionsModifier::SiteAccess site_access =
-      modifier.GetSiteAccess(web_contents->GetLastCommittedURL());
+      GetSiteAccessForMenu(page_access_submenu_.get(), modifier,
+                           web_contents->GetLastCommittedURL());
   if (site_access.has_all_sites_access)
     return PAGE_ACCESS_RUN_ON_ALL_SITES;
   if (site_access.has_site_access)
@@ -490,7 +540,7 @@ bool ExtensionContextMenuModel::IsPageAccessCommandEnabled(
   DCHECK(modifier.CanAffectExtension());
 
   ScriptingPermissionsModifier::SiteAccess site_access =
-      modifier.GetSiteAccess(url);
+      GetSiteAccessForMenu(page_access_submenu_.get(), modifier, url);
 
   // Verify the extension wants access to the page - that's the only time these
   // commands should be shown.
@@ -546,7 +596,9 @@ void ExtensionContextMenuModel::CreatePageAccessSubmenu(
   }
 
   const int kRadioGroup = 0;
-  page_access_submenu_ = std::make_unique<ui::SimpleMenuModel>(this);
+  auto page_access_submenu = std::make_unique<PageAccessSubmenuModel>(this);
+  page_access_submenu->SetSiteAccess(url, site_access);
+  page_access_submenu_ = std::move(page_access_submenu);
 
   // Add the three options for "on click", "on this site", "on all sites".
   // Though we always add these three, some may be disabled.
@@ -597,6 +649,12 @@ void ExtensionContextMenuModel::HandlePageAccessCommand(
   if (command_id == current_access)
     return;
 
+  // The access is about to change.
+  if (page_access_submenu_) {
+    static_cast<PageAccessSubmenuModel*>(page_access_submenu_.get())
+        ->ClearSiteAccess();
+  }
+
   auto convert_page_access = [](int command_id) {
     switch (command_id) {
       case PAGE_ACCESS_RUN_ON_CLICK:
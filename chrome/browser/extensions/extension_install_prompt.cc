@@ -624,11 +624,26 @@ void ExtensionInstallPrompt::OnImageLoaded(const gfx::Image& image) {
 void ExtensionInstallPrompt::LoadImageIfNeeded() {
   // Don't override an icon that was passed in. Also, |profile_| can be null in
   // unit tests.
-  if (!icon_.empty() || !profile_) {
-    ShowConfirmation();
+  const bool needs_icon = icon_.empty() && profile_;
+
+  // Whether a tab shows the text-only permissions dialog is only known once
+  // the permissions are, so they are added before the icon load in that case.
+  if (!needs_icon || contents_) {
+    AddPromptPermissions();
+    if (!needs_icon || has_permissions_to_display_)
+      ShowConfirmation();
+    else
+      LoadImage();
     return;
   }
 
+  // The icon is decoded on ImageLoader's sequence while the permission
+  // messages are built here.
+  LoadImage();
+  AddPromptPermissions();
+}
+
+void ExtensionInstallPrompt::LoadImage() {
   extensions::ExtensionResource image = extensions::IconsInfo::GetIconResource(
       extension_.get(), extension_misc::EXTENSION_ICON_LARGE,
       ExtensionIconSet::MATCH_BIGGER);
@@ -674,7 +689,8 @@ class CloseDialogCallbackWrapper
   ExtensionInstallPrompt::DoneCallback callback_;
 };
 
-void ExtensionInstallPrompt::ShowConfirmation() {
+void ExtensionInstallPrompt::AddPromptPermissions() {
+  has_permissions_to_display_ = false;
   std::unique_ptr<const PermissionSet> permissions_to_display;
 
   if (custom_permissions_.get()) {
@@ -692,8 +708,11 @@ void ExtensionInstallPrompt::ShowConfirmation() {
   prompt_->set_extension(extension_.get());
   if (permissions_to_display) {
     prompt_->AddPermissionSet(*permissions_to_display);
+    has_permissions_to_display_ = true;
   }
+}
 
+void ExtensionInstallPrompt::ShowConfirmation() {
   prompt_->set_icon(gfx::Image::CreateFrom1xBitmap(icon_));
 
   if (show_params_->WasParentDestroyed()) {
@@ -711,7 +730,7 @@ void ExtensionInstallPrompt::ShowConfirmation() {
     LOG(INFO) << "[EXTENSIONS] contents_ is not empty, displaying prompt";
     scoped_refptr<CloseDialogCallbackWrapper> wrapper = new CloseDialogCallbackWrapper(std::move(done_callback_));
 
-    if (permissions_to_display) {
+    if (has_permissions_to_display_) {
       bool ignored;
       javascript_dialogs::AppModalDialogManager::GetInstance()->RunJavaScriptDialog(
           contents_, contents_->GetMainFrame(), content::JAVASCRIPT_DIALOG_TYPE_CONFIRM,
@@ -357,11 +357,22 @@ class ExtensionInstallPrompt {
   // ImageLoader callback.
   void OnImageLoaded(const gfx::Image& image);
 
+  // Adds the permissions to display to |prompt_| and sets
+  // |has_permissions_to_display_| accordingly.
+  void AddPromptPermissions();
+
   // Starts the process of showing a confirmation UI, which is split into two.
-  // 1) Set off a 'load icon' task.
+  // 1) Set off a 'load icon' task, then add the permissions to |prompt_| while
+  //    the icon is decoded.
   // 2) Handle the load icon response and show the UI (OnImageLoaded).
+  // The icon is not loaded for the permissions dialog of a tab, which is text
+  // only, so that dialog is shown right away.
   void LoadImageIfNeeded();
 
+  // Loads the extension's icon asynchronously; the response is sent to
+  // OnImageLoaded.
+  void LoadImage();
+
   // Shows the actual UI (the icon should already be loaded).
   void ShowConfirmation();
 
@@ -386,7 +397,7 @@ class ExtensionInstallPrompt {
   // The object responsible for doing the UI specific actions.
   std::unique_ptr<extensions::ExtensionInstallUI> install_ui_;
 
-  content::WebContents* contents_;
+  content::WebContents* contents_ = nullptr;
 
   // Parameters to show the confirmation UI.
   std::unique_ptr<ExtensionInstallPromptShowParams> show_params_;
@@ -397,6 +408,9 @@ class ExtensionInstallPrompt {
   // A pre-filled prompt.
   std::unique_ptr<Prompt> prompt_;
 
+  // Whether the last AddPromptPermissions() found permissions to display.
+  bool has_permissions_to_display_ = false;
+
   // Used to show the confirm dialog.
   ShowDialogCallback show_dialog_callback_;
 
@@ -6,6 +6,7 @@
 
 #include "chrome/common/url_constants.h"
 #include "components/dom_distiller/core/url_constants.h"
+#include "components/history/core/browser/visit_exclusion_filter.h"
 #include "url/gurl.h"
 
 bool CanAddURLToHistory(const GURL& url) {
@@ -26,14 +27,7 @@ bool CanAddURLToHistory(const GURL& url) {
       url.SchemeIs(dom_distiller::kDomDistillerScheme))
     return false;
 
-  if (url.host() == "search.kiwibrowser.org" ||
-      url.host() == "bsearch.kiwibrowser.org" ||
-      url.host() == "ysearch.kiwibrowser.org" ||
-      url.host() == "kiwisearchservices.com" ||
-      url.host() == "kiwisearchservices.net" ||
-      url.host() == "www.kiwisearchservices.com" ||
-      url.host() == "www.kiwisearchservices.net" ||
-      (url.host() == "news.google.com" && url.path().rfind("/articles/", 0) == 0))
+  if (history::VisitExclusionFilter::GetInstance().ExcludesURL(url))
     return false;
 
   return true;
@@ -6,6 +6,8 @@
 
 #include <stddef.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
@@ -35,6 +37,7 @@
 #include "chrome/browser/ui/webui/theme_source.h"
 #include "chrome/common/chrome_paths.h"
 #include "chrome/common/pref_names.h"
+#include "chrome/common/search/instant_types.h"
 #include "chrome/common/search/search.mojom.h"
 #include "chrome/common/url_constants.h"
 #include "chrome/grit/theme_resources.h"
@@ -58,8 +61,52 @@
 #include "ui/gfx/color_palette.h"
 #include "ui/gfx/color_utils.h"
 
+#if defined(OS_ANDROID)
+#include "base/android/sys_utils.h"
+#endif
+
 #include "chrome/browser/search/new_tab_page_source.h"
 
+namespace {
+
+// A new tab page already gets the tiles InstantService holds when it commits,
+// so the refresh it asks for can be skipped if one just happened: the tiles
+// also follow history changes on their own.
+constexpr base::TimeDelta kMinMostVisitedRefreshInterval =
+    base::TimeDelta::FromSeconds(5);
+
+// Whether a spare renderer should be kept ready for the next new tab page.
+// Low-end devices cannot spare the memory, nor can any device that is
+// currently low on it.
+bool ShouldWarmUpNtpRenderer() {
+#if defined(OS_ANDROID)
+  static const bool is_low_end_device =
+      base::android::SysUtils::IsLowEndDeviceFromJni();
+  return !is_low_end_device &&
+         !base::android::SysUtils::IsCurrentlyLowMemory();
+#else
+  return true;
+#endif
+}
+
+// Returns true if the NTP would show |a| and |b| the same way. Matches what
+// SearchBox compares before it updates the tiles.
+bool AreMostVisitedItemsEqual(const std::vector<InstantMostVisitedItem>& a,
+                              const std::vector<InstantMostVisitedItem>& b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].url != b[i].url || a[i].title != b[i].title ||
+        a[i].favicon != b[i].favicon || a[i].source != b[i].source ||
+        a[i].title_source != b[i].title_source) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 InstantService::InstantService(Profile* profile)
     : profile_(profile),
       most_visited_info_(std::make_unique<InstantMostVisitedInfo>()),
@@ -132,16 +179,27 @@ void InstantService::RemoveObserver(InstantServiceObserver* observer) {
 }
 
 void InstantService::OnNewTabPageOpened() {
-  LOG(INFO) << "[Kiwi] InstantService::OnNewTabPageOpened: " << most_visited_sites_;
-  if (most_visited_sites_) {
-    most_visited_sites_->Refresh();
-    most_visited_sites_->RefreshTiles();
+  // Opening an NTP is a good hint that another one will follow; have a
+  // process ready for it so it does not wait for a launch. The tiles and the
+  // theme are kept by this service and sent to it on commit.
+  if (ShouldWarmUpNtpRenderer())
+    content::RenderProcessHost::WarmupSpareRenderProcessHost(profile_);
+
+  if (!most_visited_sites_)
+    return;
+  const base::TimeTicks now = base::TimeTicks::Now();
+  if (!last_most_visited_refresh_.is_null() &&
+      now - last_most_visited_refresh_ < kMinMostVisitedRefreshInterval) {
+    return;
   }
+  last_most_visited_refresh_ = now;
+  most_visited_sites_->Refresh();
+  most_visited_sites_->RefreshTiles();
 }
 
 void InstantService::OnThemeChanged() {
   theme_ = nullptr;
-  UpdateNtpTheme();
+  UpdateNtpThemeIfChanged();
 }
 
 void InstantService::DeleteMostVisitedItem(const GURL& url) {
@@ -169,6 +227,18 @@ void InstantService::UpdateNtpTheme() {
   NotifyAboutNtpTheme();
 }
 
+void InstantService::UpdateNtpThemeIfChanged() {
+  ApplyOrResetCustomBackgroundNtpTheme();
+  SetNtpElementsNtpTheme();
+
+  // Theme, native theme and custom background notifications often leave the
+  // NTP looking the same, e.g. a background refresh to the same image. Open
+  // NTPs already have that theme.
+  if (last_notified_theme_ && *last_notified_theme_ == *theme_)
+    return;
+  NotifyAboutNtpTheme();
+}
+
 void InstantService::UpdateMostVisitedInfo() {
   NotifyAboutMostVisitedInfo();
 }
@@ -226,7 +296,7 @@ void InstantService::Shutdown() {
 
 void InstantService::OnCustomBackgroundImageUpdated() {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-  UpdateNtpTheme();
+  UpdateNtpThemeIfChanged();
 }
 
 void InstantService::OnNtpCustomBackgroundServiceShuttingDown() {
@@ -265,18 +335,18 @@ void InstantService::OnNativeThemeUpdated(ui::NativeTheme* observed_theme) {
   // Force the theme information to rebuild so the correct using_dark_colors
   // value is sent to the renderer.
   BuildNtpTheme();
-  UpdateNtpTheme();
+  UpdateNtpThemeIfChanged();
 }
 
 void InstantService::OnURLsAvailable(
     const std::map<ntp_tiles::SectionType, ntp_tiles::NTPTilesVector>&
         sections) {
   DCHECK(most_visited_sites_);
-  most_visited_info_->items.clear();
   // Use only personalized tiles for instant service.
   const ntp_tiles::NTPTilesVector& tiles =
       sections.at(ntp_tiles::SectionType::PERSONALIZED);
-  LOG(INFO) << "[Kiwi] InstantService::OnURLsAvailable - tiles: " << tiles.size();
+  std::vector<InstantMostVisitedItem> items;
+  items.reserve(tiles.size());
   for (const ntp_tiles::NTPTile& tile : tiles) {
     InstantMostVisitedItem item;
     item.url = tile.url;
@@ -285,21 +355,28 @@ void InstantService::OnURLsAvailable(
     item.source = tile.source;
     item.title_source = tile.title_source;
     item.data_generation_time = tile.data_generation_time;
-    most_visited_info_->items.push_back(item);
+    items.push_back(std::move(item));
   }
 
+  // Every refresh reports the tiles again, mostly unchanged; only send them to
+  // the open NTPs when they would render differently.
+  if (!items.empty() &&
+      AreMostVisitedItemsEqual(items, most_visited_info_->items)) {
+    return;
+  }
+  most_visited_info_->items = std::move(items);
   NotifyAboutMostVisitedInfo();
 }
 
 void InstantService::OnIconMadeAvailable(const GURL& site_url) {}
 
 void InstantService::NotifyAboutMostVisitedInfo() {
-  LOG(INFO) << "[Kiwi] InstantService::NotifyAboutMostVisitedInfo";
   for (InstantServiceObserver& observer : observers_)
     observer.MostVisitedInfoChanged(*most_visited_info_);
 }
 
 void InstantService::NotifyAboutNtpTheme() {
+  last_notified_theme_ = std::make_unique<NtpTheme>(*theme_);
   for (InstantServiceObserver& observer : observers_)
     observer.NtpThemeChanged(*theme_);
 }
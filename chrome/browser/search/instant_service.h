@@ -194,6 +194,10 @@ class InstantService : public KeyedService,
   void NotifyAboutMostVisitedInfo();
   void NotifyAboutNtpTheme();
 
+  // Like UpdateNtpTheme(), but only notifies the observers if the theme
+  // differs from the one they were last sent.
+  void UpdateNtpThemeIfChanged();
+
   void BuildNtpTheme();
 
   void ApplyOrResetCustomBackgroundNtpTheme();
@@ -225,6 +229,9 @@ class InstantService : public KeyedService,
   // Theme-related data for NTP overlay to adopt themes.
   std::unique_ptr<NtpTheme> theme_;
 
+  // The theme observers were last notified about.
+  std::unique_ptr<NtpTheme> last_notified_theme_;
+
   base::ObserverList<InstantServiceObserver>::Unchecked observers_;
 
   content::NotificationRegistrar registrar_;
@@ -249,6 +256,9 @@ class InstantService : public KeyedService,
 
   base::TimeTicks background_updated_timestamp_;
 
+  // When OnNewTabPageOpened() last refreshed the Most Visited tiles.
+  base::TimeTicks last_most_visited_refresh_;
+
   base::WeakPtrFactory<InstantService> weak_ptr_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(InstantService);
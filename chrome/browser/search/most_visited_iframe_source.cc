@@ -4,6 +4,8 @@
 
 #include "chrome/browser/search/most_visited_iframe_source.h"
 
+#include <utility>
+
 #include "base/memory/ref_counted_memory.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
@@ -26,6 +28,8 @@ const char kTitleHTMLPath[] = "/title.html";
 const char kTitleCSSPath[] = "/title.css";
 const char kTitleJSPath[] = "/title.js";
 
+const size_t kMaxCachedScriptsWithOrigin = 16;
+
 }  // namespace
 
 MostVisitedIframeSource::MostVisitedIframeSource() = default;
@@ -97,9 +101,12 @@ bool MostVisitedIframeSource::ServesPath(const std::string& path) const {
 void MostVisitedIframeSource::SendResource(
     int resource_id,
     content::URLDataSource::GotDataCallback callback) {
-  std::move(callback).Run(
-      ui::ResourceBundle::GetSharedInstance().LoadDataResourceBytes(
-          resource_id));
+  scoped_refptr<base::RefCountedMemory>& bytes = resources_[resource_id];
+  if (!bytes) {
+    bytes = ui::ResourceBundle::GetSharedInstance().LoadDataResourceBytes(
+        resource_id);
+  }
+  std::move(callback).Run(bytes);
 }
 
 void MostVisitedIframeSource::SendJSWithOrigin(
@@ -112,11 +119,22 @@ void MostVisitedIframeSource::SendJSWithOrigin(
     return;
   }
 
-  std::string response =
-      ui::ResourceBundle::GetSharedInstance().LoadDataResourceString(
-          resource_id);
-  base::ReplaceFirstSubstringAfterOffset(&response, 0, "{{ORIGIN}}", origin);
-  std::move(callback).Run(base::RefCountedString::TakeString(&response));
+  auto key = std::make_pair(resource_id, origin);
+  auto it = scripts_with_origin_.find(key);
+  if (it == scripts_with_origin_.end()) {
+    // Only a handful of NTP origins are ever seen.
+    if (scripts_with_origin_.size() >= kMaxCachedScriptsWithOrigin)
+      scripts_with_origin_.clear();
+    std::string response =
+        ui::ResourceBundle::GetSharedInstance().LoadDataResourceString(
+            resource_id);
+    base::ReplaceFirstSubstringAfterOffset(&response, 0, "{{ORIGIN}}", origin);
+    it = scripts_with_origin_
+             .emplace(std::move(key),
+                      base::RefCountedString::TakeString(&response))
+             .first;
+  }
+  std::move(callback).Run(it->second);
 }
 
 bool MostVisitedIframeSource::GetOrigin(
@@ -5,7 +5,14 @@
 #ifndef CHROME_BROWSER_SEARCH_MOST_VISITED_IFRAME_SOURCE_H_
 #define CHROME_BROWSER_SEARCH_MOST_VISITED_IFRAME_SOURCE_H_
 
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/containers/flat_map.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_refptr.h"
 #include "build/build_config.h"
 #include "content/public/browser/url_data_source.h"
 
@@ -56,6 +63,16 @@ class MostVisitedIframeSource : public content::URLDataSource {
                          std::string* origin) const;
 
  private:
+  // Responses are kept once built, since every tile iframe of every NTP asks
+  // for the same few files. Requests arrive on the UI thread.
+  //
+  // Resource bytes by id; compressed resources would otherwise be
+  // decompressed for each request.
+  base::flat_map<int, scoped_refptr<base::RefCountedMemory>> resources_;
+  // SendJSWithOrigin() responses by resource id and origin.
+  std::map<std::pair<int, std::string>, scoped_refptr<base::RefCountedMemory>>
+      scripts_with_origin_;
+
   DISALLOW_COPY_AND_ASSIGN(MostVisitedIframeSource);
 };
 
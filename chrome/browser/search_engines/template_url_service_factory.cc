@@ -8,6 +8,7 @@
 
 #include "base/bind.h"
 #include "build/build_config.h"
+#include "chrome/browser/after_startup_task_utils.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/history/history_service_factory.h"
 #include "chrome/browser/profiles/incognito_helpers.h"
@@ -21,6 +22,9 @@
 #include "components/search_engines/default_search_manager.h"
 #include "components/search_engines/search_engines_pref_names.h"
 #include "components/search_engines/template_url_service.h"
+#include "components/startup_fetch/startup_fetch_scheduler.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/storage_partition.h"
 #include "rlz/buildflags/buildflags.h"
 
@@ -68,6 +72,12 @@ TemplateURLServiceFactory::TemplateURLServiceFactory()
         BrowserContextDependencyManager::GetInstance()) {
   DependsOn(HistoryServiceFactory::GetInstance());
   DependsOn(WebDataServiceFactory::GetInstance());
+  // The search engine catalog and popular sites fetches wait until startup
+  // is over. Runs right away if it already is.
+  AfterStartupTaskUtils::PostTask(
+      FROM_HERE, content::GetUIThreadTaskRunner({}),
+      base::BindOnce(&StartupFetchScheduler::NotifyStartupComplete,
+                     base::Unretained(&StartupFetchScheduler::Get())));
 }
 
 TemplateURLServiceFactory::~TemplateURLServiceFactory() {}
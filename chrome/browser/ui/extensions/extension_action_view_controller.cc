@@ -4,8 +4,10 @@
 
 #include "chrome/browser/ui/extensions/extension_action_view_controller.h"
 
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "base/bind.h"
@@ -13,8 +15,10 @@
 #include "base/metrics/histogram_functions.h"
 #include "base/strings/strcat.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/supports_user_data.h"
 #include "chrome/browser/extensions/api/commands/command_service.h"
 #include "chrome/browser/extensions/api/extension_action/extension_action_api.h"
+#include "chrome/browser/extensions/extension_action_icon_factory.h"
 #include "chrome/browser/extensions/extension_action_runner.h"
 #include "chrome/browser/extensions/extension_util.h"
 #include "chrome/browser/extensions/extension_view.h"
@@ -28,6 +32,7 @@
 #include "chrome/browser/ui/toolbar/toolbar_action_view_delegate.h"
 #include "chrome/grit/generated_resources.h"
 #include "components/sessions/content/session_tab_helper.h"
+#include "content/public/browser/web_contents.h"
 #include "extensions/browser/extension_action.h"
 #include "extensions/browser/extension_action_manager.h"
 #include "extensions/browser/extension_registry.h"
@@ -35,7 +40,10 @@
 #include "extensions/common/extension.h"
 #include "extensions/common/manifest_constants.h"
 #include "extensions/common/permissions/api_permission.h"
+#include "third_party/skia/include/core/SkColor.h"
 #include "ui/base/l10n/l10n_util.h"
+#include "ui/gfx/geometry/size.h"
+#include "ui/gfx/image/image.h"
 #include "ui/gfx/image/image_skia.h"
 #include "ui/gfx/image/image_skia_operations.h"
 
@@ -46,6 +54,106 @@ using extensions::ActionInfo;
 using extensions::CommandService;
 using extensions::ExtensionActionRunner;
 
+namespace {
+
+// Everything an action's toolbar icon is drawn from, for one tab.
+struct ActionIconState {
+  bool operator==(const ActionIconState& other) const {
+    return size == other.size && badge_text == other.badge_text &&
+           badge_text_color == other.badge_text_color &&
+           badge_background_color == other.badge_background_color &&
+           grayscale == other.grayscale && was_blocked == other.was_blocked &&
+           icon.IsEmpty() == other.icon.IsEmpty() &&
+           (icon.IsEmpty() || icon.ToImageSkia()->BackedBySameObjectAs(
+                                  *other.icon.ToImageSkia()));
+  }
+
+  gfx::Size size;
+  gfx::Image icon;
+  std::string badge_text;
+  SkColor badge_text_color = SK_ColorTRANSPARENT;
+  SkColor badge_background_color = SK_ColorTRANSPARENT;
+  bool grayscale = false;
+  bool was_blocked = false;
+};
+
+ActionIconState GetActionIconState(ExtensionActionIconFactory& icon_factory,
+                                   extensions::ExtensionAction& action,
+                                   int tab_id,
+                                   const gfx::Size& size,
+                                   bool can_interact_with_page,
+                                   bool was_blocked) {
+  ActionIconState state;
+  state.size = size;
+  state.icon = icon_factory.GetIcon(tab_id);
+  state.badge_text = action.GetDisplayBadgeText(tab_id);
+  if (!state.badge_text.empty()) {
+    state.badge_text_color = action.GetBadgeTextColor(tab_id);
+    state.badge_background_color = action.GetBadgeBackgroundColor(tab_id);
+  }
+  // We only grayscale the icon if it cannot interact with the page and the icon
+  // is disabled.
+  state.grayscale = !can_interact_with_page && !action.GetIsVisible(tab_id);
+  state.was_blocked = was_blocked;
+  return state;
+}
+
+std::unique_ptr<IconWithBadgeImageSource> CreateIconImageSource(
+    const ActionIconState& state) {
+  auto image_source = std::make_unique<IconWithBadgeImageSource>(state.size);
+  image_source->SetIcon(state.icon);
+  std::unique_ptr<IconWithBadgeImageSource::Badge> badge;
+  if (!state.badge_text.empty()) {
+    badge = std::make_unique<IconWithBadgeImageSource::Badge>(
+        state.badge_text, state.badge_text_color,
+        state.badge_background_color);
+  }
+  image_source->SetBadge(std::move(badge));
+  image_source->set_grayscale(state.grayscale);
+  image_source->set_paint_blocked_actions_decoration(state.was_blocked);
+  return image_source;
+}
+
+// The action icons last returned for a tab, by extension and size. Handing
+// out the same gfx::Image while nothing changed keeps the badge and grayscale
+// rendering that ImageSkia already did, so switching tabs does not repaint
+// the icons of every pinned extension. Lives as long as the tab; UI thread
+// only.
+class ActionIconCache : public base::SupportsUserData::Data {
+ public:
+  struct Entry {
+    ActionIconState state;
+    gfx::Image image;
+  };
+
+  static ActionIconCache* Get(content::WebContents* web_contents) {
+    auto* cache =
+        static_cast<ActionIconCache*>(web_contents->GetUserData(UserDataKey()));
+    if (!cache) {
+      auto new_cache = std::make_unique<ActionIconCache>();
+      cache = new_cache.get();
+      web_contents->SetUserData(UserDataKey(), std::move(new_cache));
+    }
+    return cache;
+  }
+
+  Entry& GetEntry(const extensions::ExtensionId& extension_id,
+                  const gfx::Size& size) {
+    return entries_[std::make_tuple(extension_id, size.width(),
+                                    size.height())];
+  }
+
+ private:
+  static const void* UserDataKey() {
+    static const int kKey = 0;
+    return &kKey;
+  }
+
+  std::map<std::tuple<extensions::ExtensionId, int, int>, Entry> entries_;
+};
+
+}  // namespace
+
 // static
 std::unique_ptr<ExtensionActionViewController>
 ExtensionActionViewController::Create(
@@ -115,8 +223,25 @@ gfx::Image ExtensionActionViewController::GetIcon(
   if (!ExtensionIsValid())
     return gfx::Image();
 
-  return gfx::Image(
-      gfx::ImageSkia(GetIconImageSource(web_contents, size), size));
+  ActionIconState state = GetActionIconState(
+      icon_factory_, *extension_action_,
+      sessions::SessionTabHelper::IdForTab(web_contents).id(), size,
+      GetPageInteractionStatus(web_contents) != PageInteractionStatus::kNone,
+      HasBeenBlocked(web_contents));
+
+  // Without a tab (e.g. during teardown) there is nothing to keep the icon
+  // with.
+  if (!web_contents)
+    return gfx::Image(gfx::ImageSkia(CreateIconImageSource(state), size));
+
+  ActionIconCache::Entry& cached =
+      ActionIconCache::Get(web_contents)->GetEntry(extension_->id(), size);
+  if (cached.image.IsEmpty() || !(cached.state == state)) {
+    cached.image =
+        gfx::Image(gfx::ImageSkia(CreateIconImageSource(state), size));
+    cached.state = std::move(state);
+  }
+  return cached.image;
 }
 
 std::u16string ExtensionActionViewController::GetActionName() const {
@@ -452,36 +577,11 @@ std::unique_ptr<IconWithBadgeImageSource>
 ExtensionActionViewController::GetIconImageSource(
     content::WebContents* web_contents,
     const gfx::Size& size) {
-  int tab_id = sessions::SessionTabHelper::IdForTab(web_contents).id();
-  std::unique_ptr<IconWithBadgeImageSource> image_source(
-      new IconWithBadgeImageSource(size));
-
-  image_source->SetIcon(icon_factory_.GetIcon(tab_id));
-
-  std::unique_ptr<IconWithBadgeImageSource::Badge> badge;
-  std::string badge_text = extension_action_->GetDisplayBadgeText(tab_id);
-  if (!badge_text.empty()) {
-    badge = std::make_unique<IconWithBadgeImageSource::Badge>(
-        badge_text, extension_action_->GetBadgeTextColor(tab_id),
-        extension_action_->GetBadgeBackgroundColor(tab_id));
-  }
-  image_source->SetBadge(std::move(badge));
-
-  bool grayscale = false;
-  bool was_blocked = false;
-  bool action_is_visible = extension_action_->GetIsVisible(tab_id);
-  PageInteractionStatus interaction_status =
-      GetPageInteractionStatus(web_contents);
-  // We only grayscale the icon if it cannot interact with the page and the icon
-  // is disabled.
-  grayscale =
-      interaction_status == PageInteractionStatus::kNone && !action_is_visible;
-  was_blocked = HasBeenBlocked(web_contents);
-
-  image_source->set_grayscale(grayscale);
-  image_source->set_paint_blocked_actions_decoration(was_blocked);
-
-  return image_source;
+  return CreateIconImageSource(GetActionIconState(
+      icon_factory_, *extension_action_,
+      sessions::SessionTabHelper::IdForTab(web_contents).id(), size,
+      GetPageInteractionStatus(web_contents) != PageInteractionStatus::kNone,
+      HasBeenBlocked(web_contents)));
 }
 
 bool ExtensionActionViewController::HasActiveTabAndCanAccess(
@@ -16,6 +16,7 @@
 #include "base/macros.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/user_metrics.h"
+#include "base/strings/strcat.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
@@ -92,20 +93,26 @@ void Dispatch(blink::WebLocalFrame* frame, const blink::WebString& script) {
   frame->ExecuteScript(blink::WebScriptSource(script));
 }
 
+// Returns the part of the favicon URLs of newTabPage.mostVisited that is the
+// same for all the items: "chrome-search://favicon/size/16@<dpr>x/<frame_id>/".
+std::string GetMostVisitedFaviconUrlPrefix(float device_pixel_ratio,
+                                           int render_frame_id) {
+  return base::StringPrintf("chrome-search://favicon/size/16@%fx/%d/",
+                            device_pixel_ratio, render_frame_id);
+}
+
 // Populates a Javascript MostVisitedItem object for returning from
 // newTabPage.mostVisited. This does not include private data such as "url" or
-// "title".
+// "title". |favicon_url_prefix| comes from GetMostVisitedFaviconUrlPrefix().
 v8::Local<v8::Object> GenerateMostVisitedItem(
     v8::Isolate* isolate,
-    float device_pixel_ratio,
-    int render_frame_id,
+    const std::string& favicon_url_prefix,
     InstantRestrictedID restricted_id) {
   return gin::DataObjectBuilder(isolate)
       .Set("rid", restricted_id)
       .Set("faviconUrl",
-           base::StringPrintf("chrome-search://favicon/size/16@%fx/%d/%d",
-                              device_pixel_ratio, render_frame_id,
-                              restricted_id))
+           base::StrCat(
+               {favicon_url_prefix, base::NumberToString(restricted_id)}))
       .Build();
 }
 
@@ -678,7 +685,8 @@ v8::Local<v8::Value> NewTabPageBindings::GetMostVisited(v8::Isolate* isolate) {
       blink::PageZoomLevelToZoomFactor(render_frame->GetWebView()->ZoomLevel());
   float device_pixel_ratio = render_frame->GetDeviceScaleFactor() * zoom_factor;
 
-  int render_frame_id = render_frame->GetRoutingID();
+  const std::string favicon_url_prefix = GetMostVisitedFaviconUrlPrefix(
+      device_pixel_ratio, render_frame->GetRoutingID());
 
   std::vector<InstantMostVisitedItemIDPair> instant_mv_items;
   search_box->GetMostVisitedItems(&instant_mv_items);
@@ -690,8 +698,7 @@ v8::Local<v8::Value> NewTabPageBindings::GetMostVisited(v8::Isolate* isolate) {
     v8_mv_items
         ->CreateDataProperty(
             context, i,
-            GenerateMostVisitedItem(isolate, device_pixel_ratio,
-                                    render_frame_id, rid))
+            GenerateMostVisitedItem(isolate, favicon_url_prefix, rid))
         .Check();
   }
   return v8_mv_items;
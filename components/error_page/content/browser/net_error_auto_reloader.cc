@@ -5,9 +5,16 @@
 #include "components/error_page/content/browser/net_error_auto_reloader.h"
 
 #include <algorithm>
+#include <memory>
 
 #include "base/callback.h"
+#include "base/containers/circular_deque.h"
 #include "base/logging.h"
+#include "base/rand_util.h"
+#include "base/sequence_checker.h"
+#include "base/supports_user_data.h"
+#include "base/timer/timer.h"
+#include "content/public/browser/browser_context.h"
 #include "content/public/browser/navigation_handle.h"
 #include "content/public/browser/navigation_throttle.h"
 #include "content/public/browser/network_service_instance.h"
@@ -66,6 +73,76 @@ base::TimeDelta GetNextReloadDelay(size_t reload_count) {
   return kDelays[std::min(reload_count, base::size(kDelays) - 1)];
 }
 
+// Spaces out the auto-reloads of all the tabs of a browser context. When the
+// connection comes back, every tab sitting on an error page resumes at once;
+// instead of all of them reloading in the same instant, they take turns, at
+// most one every kReloadSpacing plus up to kReloadJitter. Lives as long as the
+// browser context, so that its timer never outlives the UI sequence it runs
+// on.
+class AutoReloadCoordinator : public base::SupportsUserData::Data {
+ public:
+  // Returns true if it reloaded, false if the tab no longer wanted to.
+  using ReloadCallback = base::OnceCallback<bool()>;
+
+  static AutoReloadCoordinator* Get(content::BrowserContext* browser_context) {
+    auto* coordinator = static_cast<AutoReloadCoordinator*>(
+        browser_context->GetUserData(UserDataKey()));
+    if (!coordinator) {
+      auto new_coordinator = std::make_unique<AutoReloadCoordinator>();
+      coordinator = new_coordinator.get();
+      browser_context->SetUserData(UserDataKey(), std::move(new_coordinator));
+    }
+    return coordinator;
+  }
+
+  AutoReloadCoordinator() = default;
+  AutoReloadCoordinator(const AutoReloadCoordinator&) = delete;
+  AutoReloadCoordinator& operator=(const AutoReloadCoordinator&) = delete;
+  ~AutoReloadCoordinator() override = default;
+
+  void RequestReload(ReloadCallback reload) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    pending_.push_back(std::move(reload));
+    if (!spacing_timer_.IsRunning())
+      RunNext();
+  }
+
+ private:
+  static const void* UserDataKey() {
+    static const int kKey = 0;
+    return &kKey;
+  }
+
+  static constexpr base::TimeDelta kReloadSpacing =
+      base::TimeDelta::FromMilliseconds(500);
+  static constexpr int kReloadJitterMs = 250;
+
+  void RunNext() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    // Requests of tabs that went away or were paused in the meantime do not
+    // use up a turn.
+    bool reloaded = false;
+    while (!reloaded && !pending_.empty()) {
+      ReloadCallback reload = std::move(pending_.front());
+      pending_.pop_front();
+      reloaded = std::move(reload).Run();
+    }
+    if (!reloaded)
+      return;
+    spacing_timer_.Start(
+        FROM_HERE,
+        kReloadSpacing + base::TimeDelta::FromMilliseconds(
+                             base::RandInt(0, kReloadJitterMs)),
+        base::BindOnce(&AutoReloadCoordinator::RunNext,
+                       base::Unretained(this)));
+  }
+
+  base::circular_deque<ReloadCallback> pending_;
+  base::OneShotTimer spacing_timer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
 // Helper to block a navigation that would result in re-committing the same
 // error page a tab is already displaying.
 class IgnoreDuplicateErrorThrottle : public content::NavigationThrottle {
@@ -293,9 +370,25 @@ void NetErrorAutoReloader::ReloadMainFrame() {
   if (!is_online_ || !IsWebContentsVisible())
     return;
 
-  ++num_reloads_for_current_error_;
-  is_auto_reload_in_progress_ = true;
-  web_contents()->GetMainFrame()->Reload();
+  // Wait for this tab's turn. By then the reload may have been paused or
+  // reset, which drops |next_reload_timer_|, or the tab may have gone into
+  // the background or offline.
+  AutoReloadCoordinator* coordinator =
+      AutoReloadCoordinator::Get(web_contents()->GetBrowserContext());
+  coordinator->RequestReload(base::BindOnce(
+      [](base::WeakPtr<NetErrorAutoReloader> reloader) {
+        if (!reloader || !reloader->next_reload_timer_ ||
+            !reloader->current_reloadable_error_page_info_ ||
+            !reloader->is_online_ || !reloader->IsWebContentsVisible() ||
+            reloader->web_contents()->WasDiscarded()) {
+          return false;
+        }
+        ++reloader->num_reloads_for_current_error_;
+        reloader->is_auto_reload_in_progress_ = true;
+        reloader->web_contents()->GetMainFrame()->Reload();
+        return true;
+      },
+      weak_ptr_factory_.GetWeakPtr()));
 }
 
 std::unique_ptr<content::NavigationThrottle>
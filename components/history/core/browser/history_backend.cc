@@ -17,7 +17,9 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/compiler_specific.h"
+#include "base/containers/flat_map.h"
 #include "base/containers/flat_set.h"
+#include "base/containers/mru_cache.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
@@ -31,6 +33,7 @@
 #include "base/single_thread_task_runner.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/system/sys_info.h"
 #include "base/time/time.h"
 #include "base/trace_event/trace_event.h"
 #include "build/build_config.h"
@@ -49,6 +52,7 @@
 #include "components/history/core/browser/page_usage_data.h"
 #include "components/history/core/browser/sync/typed_url_sync_bridge.h"
 #include "components/history/core/browser/url_utils.h"
+#include "components/history/core/browser/visit_exclusion_filter.h"
 #include "components/sync/model/client_tag_based_model_type_processor.h"
 #include "components/url_formatter/url_formatter.h"
 #include "net/base/escape.h"
@@ -58,6 +62,10 @@
 #include "url/gurl.h"
 #include "url/url_constants.h"
 
+#if defined(OS_ANDROID)
+#include "base/android/sys_utils.h"
+#endif
+
 #if defined(OS_IOS)
 #include "base/ios/scoped_critical_action.h"
 #endif
@@ -141,6 +149,10 @@ void RunUnlessCanceled(
 // How long we'll wait to do a commit, so that things are batched together.
 const int kCommitIntervalSeconds = 10;
 
+// How long QueryMostVisitedURLs() may return a cached result while visits to
+// the sites it contains keep coming in.
+const int kMostVisitedCacheMaxAgeMinutes = 60;
+
 // The maximum number of items we'll allow in the redirect list before
 // deleting some.
 const int kMaxRedirectCount = 32;
@@ -230,6 +242,223 @@ HistoryBackendHelper::HistoryBackendHelper() = default;
 
 HistoryBackendHelper::~HistoryBackendHelper() = default;
 
+// PendingVisitNotifications ---------------------------------------------------
+
+// Visit notifications collected while AddPage() writes a page and its redirect
+// chain. They are sent, one per visit and in order, once the whole chain is in
+// the database, so that the observers no longer run between the statements of
+// every hop. They are deferred, not coalesced: the observers have no batch
+// interface.
+class PendingVisitNotifications : public base::SupportsUserData::Data {
+ public:
+  struct Visit {
+    ui::PageTransition transition;
+    URLRow row;
+    RedirectList redirects;
+    base::Time visit_time;
+  };
+
+  static const void* UserDataKey() {
+    static const int kKey = 0;
+    return &kKey;
+  }
+
+  std::vector<Visit> visits;
+};
+
+// URLRowCache -----------------------------------------------------------------
+
+// Most recently used URL rows, in front of HistoryDatabase::GetRowForURL() on
+// the visit path: users keep coming back to the same few pages. Rows are
+// written through by AddPageVisit() and dropped whenever they may have changed
+// elsewhere (URLs modified or deleted, history DB tasks, closing the database).
+// On Android it keeps no more rows than on a low-end device while the system
+// is low on memory.
+class URLRowCache :
+#if defined(OS_ANDROID)
+    public base::android::SysUtils::MemoryStateObserver,
+#endif
+    public base::SupportsUserData::Data {
+ public:
+  URLRowCache()
+      : rows_(base::SysInfo::IsLowEndDevice() ? kLowEndDeviceCapacity
+                                              : kCapacity) {
+#if defined(OS_ANDROID)
+    base::android::SysUtils::AddMemoryStateObserver(this);
+#endif
+  }
+
+  ~URLRowCache() override {
+#if defined(OS_ANDROID)
+    base::android::SysUtils::RemoveMemoryStateObserver(this);
+#endif
+  }
+
+  static URLRowCache* Get(HistoryBackend* backend) {
+    auto* cache = GetIfExists(backend);
+    if (!cache) {
+      auto new_cache = std::make_unique<URLRowCache>();
+      cache = new_cache.get();
+      backend->SetUserData(UserDataKey(), std::move(new_cache));
+    }
+    return cache;
+  }
+
+  static URLRowCache* GetIfExists(const HistoryBackend* backend) {
+    return static_cast<URLRowCache*>(backend->GetUserData(UserDataKey()));
+  }
+
+  // Same contract as HistoryDatabase::GetRowForURL(); |row| may be null.
+  // Records History.URLRowCache.Hit if |record_hit| is true, which callers
+  // pass for the first lookup of a visit only.
+  URLID GetRowForURL(HistoryDatabase* db,
+                     const GURL& url,
+                     URLRow* row,
+                     bool record_hit) {
+    auto it = rows_.Get(KeyFor(url));
+    // Two URLs may share a hash; the row then belongs to the other one.
+    const bool hit = it != rows_.end() && it->second.url() == url;
+    if (record_hit)
+      UMA_HISTOGRAM_BOOLEAN("History.URLRowCache.Hit", hit);
+    if (hit) {
+      if (row)
+        *row = it->second;
+      return it->second.id();
+    }
+    URLRow found;
+    URLID url_id = db->GetRowForURL(url, &found);
+    if (!url_id)
+      return 0;
+    if (row)
+      *row = found;
+    rows_.Put(KeyFor(url), std::move(found));
+    ShrinkIfLowMemory();
+    return url_id;
+  }
+
+  void Put(const URLRow& row) {
+    rows_.Put(KeyFor(row.url()), row);
+    ShrinkIfLowMemory();
+  }
+
+  void Invalidate(const URLRows& rows) {
+    for (const URLRow& row : rows) {
+      auto it = rows_.Peek(KeyFor(row.url()));
+      if (it != rows_.end())
+        rows_.Erase(it);
+    }
+  }
+
+  void Clear() { rows_.Clear(); }
+
+#if defined(OS_ANDROID)
+  // base::android::SysUtils::MemoryStateObserver:
+  void OnMemoryStateChanged(bool is_low_memory) override {
+    is_low_memory_ = is_low_memory;
+    ShrinkIfLowMemory();
+  }
+#endif
+
+ private:
+  static constexpr size_t kCapacity = 128;
+  static constexpr size_t kLowEndDeviceCapacity = 32;
+
+  void ShrinkIfLowMemory() {
+    if (is_low_memory_)
+      rows_.ShrinkToSize(kLowEndDeviceCapacity);
+  }
+
+  static const void* UserDataKey() {
+    static const int kKey = 0;
+    return &kKey;
+  }
+
+  // Keyed by a hash of the URL, so that lookups do not copy its spec.
+  static size_t KeyFor(const GURL& url) {
+    return std::hash<std::string>()(url.spec());
+  }
+
+  base::HashingMRUCache<size_t, URLRow> rows_;
+  // Only ever set on Android.
+  bool is_low_memory_ = false;
+};
+
+// MostVisitedCache ------------------------------------------------------------
+
+// Result of the last QueryMostVisitedURLs(), so that opening new tabs does not
+// rank the segments again each time. A visit to a segment that is already in
+// the result only raises that segment's score: the set of sites stays the
+// same and only the order of the tiles may lag, so such visits keep the result
+// for up to kMostVisitedCacheMaxAgeMinutes. A visit to any other segment, and
+// any change to the URL rows (titles, deletions), drops it.
+class MostVisitedCache : public base::SupportsUserData::Data {
+ public:
+  static MostVisitedCache* Get(HistoryBackend* backend) {
+    auto* cache = GetIfExists(backend);
+    if (!cache) {
+      auto new_cache = std::make_unique<MostVisitedCache>();
+      cache = new_cache.get();
+      backend->SetUserData(UserDataKey(), std::move(new_cache));
+    }
+    return cache;
+  }
+
+  static MostVisitedCache* GetIfExists(const HistoryBackend* backend) {
+    return static_cast<MostVisitedCache*>(backend->GetUserData(UserDataKey()));
+  }
+
+  // Returns the cached result for these parameters, or null.
+  const MostVisitedURLList* Lookup(int result_count, int days_back) const {
+    if (!is_valid_ || result_count != result_count_ ||
+        days_back != days_back_ ||
+        base::TimeTicks::Now() - computed_at_ >
+            base::TimeDelta::FromMinutes(kMostVisitedCacheMaxAgeMinutes)) {
+      return nullptr;
+    }
+    return &urls_;
+  }
+
+  void Store(int result_count,
+             int days_back,
+             const std::vector<std::unique_ptr<PageUsageData>>& data,
+             const MostVisitedURLList& urls) {
+    is_valid_ = true;
+    result_count_ = result_count;
+    days_back_ = days_back;
+    computed_at_ = base::TimeTicks::Now();
+    segment_urls_.clear();
+    for (const std::unique_ptr<PageUsageData>& page : data)
+      segment_urls_[page->GetID()] = page->GetURL();
+    urls_ = urls;
+  }
+
+  // Called when a visit was counted for |segment_id|. |representation_url| is
+  // the new URL representing the segment, or empty if it did not change.
+  void OnSegmentVisited(SegmentID segment_id, const GURL& representation_url) {
+    auto it = segment_urls_.find(segment_id);
+    if (it == segment_urls_.end() ||
+        (!representation_url.is_empty() && it->second != representation_url)) {
+      Invalidate();
+    }
+  }
+
+  void Invalidate() { is_valid_ = false; }
+
+ private:
+  static const void* UserDataKey() {
+    static const int kKey = 0;
+    return &kKey;
+  }
+
+  bool is_valid_ = false;
+  int result_count_ = 0;
+  int days_back_ = 0;
+  base::TimeTicks computed_at_;
+  // Segments of the result and the URL representing each.
+  base::flat_map<SegmentID, GURL> segment_urls_;
+  MostVisitedURLList urls_;
+};
+
 // HistoryBackend --------------------------------------------------------------
 
 // static
@@ -379,6 +608,8 @@ SegmentID HistoryBackend::UpdateSegments(const GURL& url,
     return 0;
 
   SegmentID segment_id = 0;
+  // Set if this visit changes the URL representing the segment.
+  GURL representation_url;
 
   // Are we at the beginning of a new segment?
   // Note that navigating to an existing entry (with back/forward) reuses the
@@ -400,7 +631,9 @@ SegmentID HistoryBackend::UpdateSegments(const GURL& url,
       (transition_type & ui::PAGE_TRANSITION_FORWARD_BACK) == 0) {
     // If so, create or get the segment.
     std::string segment_name = db_->ComputeSegmentName(url);
-    URLID url_id = db_->GetRowForURL(url, nullptr);
+    URLID url_id =
+        URLRowCache::Get(this)->GetRowForURL(db_.get(), url, nullptr,
+                                             /*record_hit=*/false);
     if (!url_id)
       return 0;
 
@@ -416,6 +649,7 @@ SegmentID HistoryBackend::UpdateSegments(const GURL& url,
       // represent that segment in order to minimize stale most visited
       // images.
       db_->UpdateSegmentRepresentationURL(segment_id, url_id);
+      representation_url = url;
     }
   } else {
     // Note: it is possible there is no segment ID set for this visit chain.
@@ -438,6 +672,8 @@ SegmentID HistoryBackend::UpdateSegments(const GURL& url,
     NOTREACHED();
     return 0;
   }
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->OnSegmentVisited(segment_id, representation_url);
   return segment_id;
 }
 
@@ -590,6 +826,10 @@ void HistoryBackend::AddPage(const HistoryAddPageArgs& request) {
   if (!db_)
     return;
 
+  DCHECK(!GetUserData(PendingVisitNotifications::UserDataKey()));
+  SetUserData(PendingVisitNotifications::UserDataKey(),
+              std::make_unique<PendingVisitNotifications>());
+
   // Will be filled with the URL ID and the visit ID of the last addition.
   std::pair<URLID, VisitID> last_ids(
       0, tracker_.GetLastVisit(request.context_id, request.nav_entry_id,
@@ -803,6 +1043,17 @@ void HistoryBackend::AddPage(const HistoryAddPageArgs& request) {
                       last_ids.second);
   }
 
+  std::vector<PendingVisitNotifications::Visit> visits =
+      std::move(static_cast<PendingVisitNotifications*>(
+                    GetUserData(PendingVisitNotifications::UserDataKey()))
+                    ->visits);
+  supports_user_data_helper_->RemoveUserData(
+      PendingVisitNotifications::UserDataKey());
+  for (const auto& visit : visits) {
+    NotifyURLVisited(visit.transition, visit.row, visit.redirects,
+                     visit.visit_time);
+  }
+
   ScheduleCommit();
 }
 
@@ -927,9 +1178,17 @@ void HistoryBackend::OnMemoryPressure(
     db_->TrimMemory();
   if (favicon_backend_)
     favicon_backend_->TrimMemory();
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this))
+    url_row_cache->Clear();
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
 }
 
 void HistoryBackend::CloseAllDatabases() {
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this))
+    url_row_cache->Clear();
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
   if (db_) {
     // Commit the long-running transaction.
     db_->CommitTransaction();
@@ -950,33 +1209,14 @@ std::pair<URLID, VisitID> HistoryBackend::AddPageVisit(
     bool should_increment_typed_count,
     bool floc_allowed,
     absl::optional<std::u16string> title) {
-  // kiwibrowser.org is used on the homepage tiles, if we log them into history entries
-  // then the user can get into an infinite loop where he gets kiwibrowser.org
-  // as a most visited tile and this would be polluting the history entries as well
-  if (url.is_valid() && url.spec().find(".ap01.net") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("bridge.") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("click_id=") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("clickid=") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("/goto/") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("__kb=") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("__kiwi=") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find(".kiwibrowser.org") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("search.kiwibrowser.org") != std::string::npos)
-    return std::make_pair(0, 0);
-  if (url.is_valid() && url.spec().find("kiwisearchservices.") != std::string::npos)
+  if (VisitExclusionFilter::GetInstance().ExcludesVisit(url))
     return std::make_pair(0, 0);
 
   // See if this URL is already in the DB.
+  URLRowCache* url_row_cache = URLRowCache::Get(this);
   URLRow url_info(url);
-  URLID url_id = db_->GetRowForURL(url, &url_info);
+  URLID url_id = url_row_cache->GetRowForURL(db_.get(), url, &url_info,
+                                             /*record_hit=*/true);
   if (url_id) {
     // Update of an existing row.
     if (!ui::PageTransitionCoreTypeIs(transition, ui::PAGE_TRANSITION_RELOAD))
@@ -1009,6 +1249,7 @@ std::pair<URLID, VisitID> HistoryBackend::AddPageVisit(
     }
     url_info.set_id(url_id);
   }
+  url_row_cache->Put(url_info);
 
   // Add the visit with the time to the database.
   VisitRow visit_info(url_id, time, referring_visit, transition, 0,
@@ -1889,6 +2130,12 @@ MostVisitedURLList HistoryBackend::QueryMostVisitedURLs(int result_count,
   if (!db_)
     return {};
 
+  MostVisitedCache* most_visited_cache = MostVisitedCache::Get(this);
+  if (const MostVisitedURLList* cached =
+          most_visited_cache->Lookup(result_count, days_back)) {
+    return *cached;
+  }
+
   base::TimeTicks begin_time = base::TimeTicks::Now();
 
   auto url_filter =
@@ -1903,6 +2150,7 @@ MostVisitedURLList HistoryBackend::QueryMostVisitedURLs(int result_count,
   MostVisitedURLList result;
   for (const std::unique_ptr<PageUsageData>& current_data : data)
     result.emplace_back(current_data->GetURL(), current_data->GetTitle());
+  most_visited_cache->Store(result_count, days_back, data, result);
 
   UMA_HISTOGRAM_TIMES("History.QueryMostVisitedURLsTime",
                       base::TimeTicks::Now() - begin_time);
@@ -2288,6 +2536,11 @@ void HistoryBackend::ProcessDBTaskImpl() {
   std::unique_ptr<QueuedHistoryDBTask> task =
       std::move(queued_history_db_tasks_.front());
   queued_history_db_tasks_.pop_front();
+  // The task gets the database itself and may change any row.
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this))
+    url_row_cache->Clear();
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
   if (task->Run(this, db_.get())) {
     // The task is done, notify the callback.
     task->DoneRun();
@@ -2541,6 +2794,12 @@ void HistoryBackend::NotifyURLVisited(ui::PageTransition transition,
                                       const URLRow& row,
                                       const RedirectList& redirects,
                                       base::Time visit_time) {
+  if (auto* pending = static_cast<PendingVisitNotifications*>(
+          GetUserData(PendingVisitNotifications::UserDataKey()))) {
+    pending->visits.push_back({transition, row, redirects, visit_time});
+    return;
+  }
+
   for (HistoryBackendObserver& observer : observers_)
     observer.OnURLVisited(this, transition, row, redirects, visit_time);
 
@@ -2549,6 +2808,11 @@ void HistoryBackend::NotifyURLVisited(ui::PageTransition transition,
 
 void HistoryBackend::NotifyURLsModified(const URLRows& changed_urls,
                                         bool is_from_expiration) {
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this))
+    url_row_cache->Invalidate(changed_urls);
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
+
   for (HistoryBackendObserver& observer : observers_)
     observer.OnURLsModified(this, changed_urls, is_from_expiration);
 
@@ -2556,6 +2820,15 @@ void HistoryBackend::NotifyURLsModified(const URLRows& changed_urls,
 }
 
 void HistoryBackend::NotifyURLsDeleted(DeletionInfo deletion_info) {
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this)) {
+    if (deletion_info.IsAllHistory())
+      url_row_cache->Clear();
+    else
+      url_row_cache->Invalidate(deletion_info.deleted_rows());
+  }
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
+
   std::set<GURL> origins;
   for (const history::URLRow& row : deletion_info.deleted_rows())
     origins.insert(row.url().GetOrigin());
@@ -2660,6 +2933,12 @@ void HistoryBackend::ClearAllOnDemandFavicons() {
 }
 
 bool HistoryBackend::ClearAllMainHistory(const URLRows& kept_urls) {
+  // The kept URLs get new IDs.
+  if (URLRowCache* url_row_cache = URLRowCache::GetIfExists(this))
+    url_row_cache->Clear();
+  if (MostVisitedCache* cache = MostVisitedCache::GetIfExists(this))
+    cache->Invalidate();
+
   // Create the duplicate URL table. We will copy the kept URLs into this.
   if (!db_->CreateTemporaryURLTable())
     return false;
@@ -0,0 +1,106 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_HISTORY_CORE_BROWSER_VISIT_EXCLUSION_FILTER_H_
+#define COMPONENTS_HISTORY_CORE_BROWSER_VISIT_EXCLUSION_FILTER_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/no_destructor.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+
+namespace history {
+
+// URLs that are never recorded in history: redirect hops and click trackers,
+// and the result pages of the bundled search providers, which would otherwise
+// show up as most visited tiles. Shared by HistoryBackend::AddPageVisit() and
+// CanAddURLToHistory() so both use the same lists. Immutable once built, so it
+// can be used from the UI thread and the history thread alike.
+class VisitExclusionFilter {
+ public:
+  static const VisitExclusionFilter& GetInstance() {
+    static const base::NoDestructor<VisitExclusionFilter> instance;
+    return *instance;
+  }
+
+  VisitExclusionFilter(const VisitExclusionFilter&) = delete;
+  VisitExclusionFilter& operator=(const VisitExclusionFilter&) = delete;
+
+  // Returns true if a visit to |url| must not be recorded, i.e. its spec
+  // contains one of the excluded substrings. Scans the spec once, only
+  // comparing the substrings that start with the current character.
+  bool ExcludesVisit(const GURL& url) const {
+    if (!url.is_valid())
+      return false;
+    const base::StringPiece spec = url.spec();
+    for (size_t i = 0; i < spec.size(); ++i) {
+      for (base::StringPiece substring :
+           substrings_by_first_char_[static_cast<uint8_t>(spec[i])]) {
+        if (spec.substr(i, substring.size()) == substring)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns true if |url| must not be added to history at all: its host is
+  // one of the excluded hosts and its path starts with the host's prefix.
+  bool ExcludesURL(const GURL& url) const {
+    auto it = excluded_hosts_.find(url.host_piece());
+    return it != excluded_hosts_.end() &&
+           base::StartsWith(url.path_piece(), it->second);
+  }
+
+ private:
+  friend class base::NoDestructor<VisitExclusionFilter>;
+
+  VisitExclusionFilter() {
+    // kiwibrowser.org is used on the homepage tiles, if we log them into
+    // history entries then the user can get into an infinite loop where they
+    // get kiwibrowser.org as a most visited tile and this would be polluting
+    // the history entries as well.
+    static constexpr const char* kExcludedSubstrings[] = {
+        ".ap01.net", "bridge.",          "click_id=",
+        "clickid=",  "/goto/",           "__kb=",
+        "__kiwi=",   ".kiwibrowser.org", "search.kiwibrowser.org",
+        "kiwisearchservices.",
+    };
+    for (base::StringPiece substring : kExcludedSubstrings) {
+      substrings_by_first_char_[static_cast<uint8_t>(substring[0])].push_back(
+          substring);
+    }
+
+    // Host, and the prefix the path must start with ("" for any path).
+    static constexpr std::pair<const char*, const char*> kExcludedHosts[] = {
+        {"search.kiwibrowser.org", ""},
+        {"bsearch.kiwibrowser.org", ""},
+        {"ysearch.kiwibrowser.org", ""},
+        {"kiwisearchservices.com", ""},
+        {"kiwisearchservices.net", ""},
+        {"www.kiwisearchservices.com", ""},
+        {"www.kiwisearchservices.net", ""},
+        {"news.google.com", "/articles/"},
+    };
+    std::vector<std::pair<base::StringPiece, base::StringPiece>> hosts;
+    for (const auto& host : kExcludedHosts)
+      hosts.emplace_back(host.first, host.second);
+    excluded_hosts_ = base::flat_map<base::StringPiece, base::StringPiece>(
+        std::move(hosts));
+  }
+  ~VisitExclusionFilter() = default;
+
+  std::array<std::vector<base::StringPiece>, 256> substrings_by_first_char_;
+  base::flat_map<base::StringPiece, base::StringPiece> excluded_hosts_;
+};
+
+}  // namespace history
+
+#endif  // COMPONENTS_HISTORY_CORE_BROWSER_VISIT_EXCLUSION_FILTER_H_
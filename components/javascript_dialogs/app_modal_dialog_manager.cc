@@ -8,10 +8,13 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/containers/mru_cache.h"
 #include "base/i18n/rtl.h"
 #include "base/macros.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "build/build_config.h"
 #include "components/javascript_dialogs/app_modal_dialog_queue.h"
 #include "components/javascript_dialogs/app_modal_dialog_view.h"
@@ -22,6 +25,7 @@
 #include "content/public/common/javascript_dialog_type.h"
 #include "ui/base/l10n/l10n_util.h"
 #include "ui/gfx/font_list.h"
+#include "url/origin.h"
 
 namespace javascript_dialogs {
 
@@ -56,6 +60,34 @@ bool ShouldDisplaySuppressCheckbox(
   return extra_data->has_already_shown_a_dialog_;
 }
 
+// A page looping over alert() gets a new dialog queued as soon as the user
+// closes the previous one, and the suppress checkbox only helps once the user
+// finds it. Once an origin has opened kMaxDialogsPerInterval dialogs within
+// kDialogInterval, its next ones are suppressed until the interval is over,
+// in all tabs, so that it cannot keep the UI busy.
+constexpr int kMaxDialogsPerInterval = 5;
+constexpr base::TimeDelta kDialogInterval = base::TimeDelta::FromSeconds(10);
+
+// Returns true if a dialog from |origin| must be suppressed, and counts it
+// otherwise.
+bool ShouldRateLimitDialog(const url::Origin& origin) {
+  struct DialogBurst {
+    base::TimeTicks start;
+    int count = 0;
+  };
+  // Only the origins that showed a dialog recently matter.
+  static base::NoDestructor<base::MRUCache<url::Origin, DialogBurst>> bursts(
+      32);
+  const base::TimeTicks now = base::TimeTicks::Now();
+  auto it = bursts->Get(origin);
+  if (it == bursts->end() || now - it->second.start >= kDialogInterval)
+    it = bursts->Put(origin, DialogBurst{now, 0});
+  if (it->second.count >= kMaxDialogsPerInterval)
+    return true;
+  ++it->second.count;
+  return false;
+}
+
 }  // namespace
 
 // static
@@ -173,6 +205,11 @@ void AppModalDialogManager::RunJavaScriptDialog(
     return;
   }
 
+  if (ShouldRateLimitDialog(render_frame_host->GetLastCommittedOrigin())) {
+    *did_suppress_message = true;
+    return;
+  }
+
   std::u16string dialog_title =
       GetTitle(web_contents, render_frame_host->GetLastCommittedURL());
 
@@ -29,15 +29,19 @@
 #include "components/prefs/pref_service.h"
 #include "components/search_engines/search_engine_type.h"
 #include "components/search_engines/template_url_service.h"
+#include "components/startup_fetch/startup_fetch_scheduler.h"
 #include "components/variations/service/variations_service.h"
 #include "components/variations/variations_associated_data.h"
 #include "net/base/load_flags.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
 #include "net/http/http_status_code.h"
 #include "net/traffic_annotation/network_traffic_annotation.h"
 #include "services/data_decoder/public/cpp/data_decoder.h"
 #include "services/network/public/cpp/resource_request.h"
 #include "services/network/public/cpp/shared_url_loader_factory.h"
 #include "services/network/public/cpp/simple_url_loader.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
 
 #if defined(OS_ANDROID) || defined(OS_IOS)
 #include "base/json/json_reader.h"
@@ -63,6 +67,14 @@ const char kPopularSitesDefaultVersion[] = "5";
 const int kSitesExplorationStartVersion = 6;
 const int kPopularSitesRedownloadIntervalHours = 1;
 
+// The lists are a few kilobytes; anything much larger is not a site list.
+const size_t kMaxPopularSitesResponseSize = 1024 * 1024;
+
+// ETag of the response that |kPopularSitesJsonPref| was parsed from, sent as
+// If-None-Match when that same URL is fetched again. Cleared whenever the
+// stored list comes from anywhere else.
+const char kPopularSitesETagPref[] = "popular_sites_etag";
+
 GURL GetPopularSitesURL(const std::string& directory,
                         const std::string& country,
                         const std::string& version) {
@@ -287,12 +299,23 @@ bool PopularSitesImpl::MaybeStartFetch(bool force_download,
   const bool url_changed =
       pending_url_.spec() != prefs_->GetString(prefs::kPopularSitesURLPref);
 
-  // Download forced, or we need to download a new file.
-  if (force_download || download_time_is_future ||
-      (time_since_last_download > redownload_interval) || url_changed) {
+  // A forced download is fetched right away.
+  if (force_download) {
     FetchPopularSites();
     return true;
   }
+
+  // We need to download a new file.
+  if (download_time_is_future ||
+      (time_since_last_download > redownload_interval) || url_changed) {
+    // The stored list is shown meanwhile; the fetch waits for startup to be
+    // over so it does not compete with the first page load.
+    StartupFetchScheduler::Get().Schedule(
+        StartupFetchScheduler::Priority::kHigh,
+        base::BindOnce(&PopularSitesImpl::FetchPopularSites,
+                       weak_ptr_factory_.GetWeakPtr()));
+    return true;
+  }
   return false;
 }
 
@@ -407,6 +430,7 @@ void PopularSitesImpl::RegisterProfilePrefs(
 
   user_prefs->RegisterInt64Pref(prefs::kPopularSitesLastDownloadPref, 0);
   user_prefs->RegisterStringPref(prefs::kPopularSitesURLPref, std::string());
+  user_prefs->RegisterStringPref(kPopularSitesETagPref, std::string());
   user_prefs->RegisterListPref(prefs::kPopularSitesJsonPref,
                                DefaultPopularSites());
   int version;
@@ -438,25 +462,54 @@ void PopularSitesImpl::FetchPopularSites() {
   auto resource_request = std::make_unique<network::ResourceRequest>();
   resource_request->url = pending_url_;
   resource_request->credentials_mode = network::mojom::CredentialsMode::kOmit;
+  // Only revalidate the stored list if it was downloaded from this URL.
+  const std::string& etag = prefs_->GetString(kPopularSitesETagPref);
+  if (!etag.empty() &&
+      pending_url_.spec() == prefs_->GetString(prefs::kPopularSitesURLPref) &&
+      version_in_pending_url_ ==
+          prefs_->GetInteger(prefs::kPopularSitesVersionPref)) {
+    resource_request->headers.SetHeader(net::HttpRequestHeaders::kIfNoneMatch,
+                                        etag);
+  }
   simple_url_loader_ = network::SimpleURLLoader::Create(
       std::move(resource_request), traffic_annotation);
   simple_url_loader_->SetRetryOptions(
       1, network::SimpleURLLoader::RETRY_ON_NETWORK_CHANGE);
-  simple_url_loader_->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
+  simple_url_loader_->DownloadToString(
       url_loader_factory_.get(),
       base::BindOnce(&PopularSitesImpl::OnSimpleLoaderComplete,
-                     base::Unretained(this)));
+                     base::Unretained(this)),
+      kMaxPopularSitesResponseSize);
 }
 
 void PopularSitesImpl::OnSimpleLoaderComplete(
     std::unique_ptr<std::string> response_body) {
+  const network::mojom::URLResponseHead* response_info =
+      simple_url_loader_->ResponseInfo();
+  scoped_refptr<net::HttpResponseHeaders> headers =
+      response_info ? response_info->headers : nullptr;
   simple_url_loader_.reset();
 
+  if (headers && headers->response_code() == net::HTTP_NOT_MODIFIED) {
+    // The stored list is still current; there is nothing to parse.
+    prefs_->SetInt64(prefs::kPopularSitesLastDownloadPref,
+                     base::Time::Now().ToInternalValue());
+    std::move(callback_).Run(true);
+    return;
+  }
+
   if (!response_body) {
     OnDownloadFailed();
     return;
   }
 
+  // Stored ahead of the list it belongs to; OnDownloadFailed() clears it if
+  // the list turns out not to be usable.
+  std::string etag;
+  if (!headers || !headers->EnumerateHeader(nullptr, "ETag", &etag))
+    etag.clear();
+  prefs_->SetString(kPopularSitesETagPref, etag);
+
   data_decoder::DataDecoder::ParseJsonIsolated(
       *response_body, base::BindOnce(&PopularSitesImpl::OnJsonParsed,
                                      weak_ptr_factory_.GetWeakPtr()));
@@ -488,6 +541,7 @@ void PopularSitesImpl::OnJsonParsed(
 }
 
 void PopularSitesImpl::OnDownloadFailed() {
+  prefs_->ClearPref(kPopularSitesETagPref);
   if (!is_fallback_) {
     DLOG(WARNING) << "Download country site list failed";
     is_fallback_ = true;
@@ -7,6 +7,9 @@
 #include "base/bind.h"
 #include "components/version_info/version_info_values.h"
 #include "base/json/json_string_value_serializer.h"
+#include "base/no_destructor.h"
+#include "base/strings/utf_string_conversions.h"
+#include "net/http/http_response_headers.h"
 #include "net/base/url_util.h"
 #include "net/base/load_flags.h"
 #include "base/android/sys_utils.h"
@@ -15,6 +18,7 @@
 #include "components/prefs/pref_service.h"
 #include "components/prefs/scoped_user_pref_update.h"
 #include "components/search_engines/search_engines_pref_names.h"
+#include "components/startup_fetch/startup_fetch_scheduler.h"
 #include "net/traffic_annotation/network_traffic_annotation.h"
 #include "services/network/public/cpp/shared_url_loader_factory.h"
 #include "services/network/public/cpp/simple_url_loader.h"
@@ -27,6 +31,13 @@
 
 #include "services/network/public/mojom/url_response_head.mojom.h"
 
+namespace {
+
+constexpr base::TimeDelta kNetworkChangeFetchDelay =
+    base::TimeDelta::FromSeconds(10);
+
+}  // namespace
+
 const char SearchURLFetcher::kSearchDomainCheckURL[] =
     "https://settings.kiwibrowser.com/search/getrecommendedsearch?format=domain&serie=next&type=chrome&version=" PRODUCT_VERSION "&release_name=" RELEASE_NAME "&release_version=" RELEASE_VERSION;
 
@@ -48,17 +59,26 @@ SearchURLFetcher::SearchURLFetcher(
     : url_loader_factory_(url_loader_factory),
       prefs_(prefs),
       template_url_service_(template_url_service) {
-  LOG(INFO) << "[Kiwi] List of search engines is initializing";
+  search_version_ = prefs_->GetInteger(prefs::kSearchProviderOverridesVersion);
   net::NetworkChangeNotifier::AddNetworkChangeObserver(this);
 }
 
-SearchURLFetcher::~SearchURLFetcher() {}
+SearchURLFetcher::~SearchURLFetcher() {
+  net::NetworkChangeNotifier::RemoveNetworkChangeObserver(this);
+}
 
 void SearchURLFetcher::FetchURL() {
-  // Don't allow a fetch if one is pending.
-  if (already_loaded_)
+  // Don't allow a fetch if one is pending, or once the catalog is current.
+  if (already_loaded_ || url_loader_)
+    return;
+  // The stored catalog is good enough until the first page has loaded.
+  if (!StartupFetchScheduler::Get().startup_complete()) {
+    StartupFetchScheduler::Get().Schedule(
+        StartupFetchScheduler::Priority::kLow,
+        base::BindOnce(&SearchURLFetcher::FetchURL,
+                       weak_ptr_factory_.GetWeakPtr()));
     return;
-  DCHECK(!url_loader_);
+  }
   url_loader_ = CreateURLFetcher();
   url_loader_->DownloadToStringOfUnboundedSizeUntilCrashAndDie(
       url_loader_factory_.get(),
@@ -93,14 +113,13 @@ std::unique_ptr<network::SimpleURLLoader> SearchURLFetcher::CreateURLFetcher() {
   resource_request->url = GURL(SearchURLFetcher::kSearchDomainCheckURL);
   resource_request->method = "GET";
 
-  long firstInstallDate = base::android::SysUtils::FirstInstallDateFromJni();
+  // Neither changes while the browser runs; avoid the JNI calls on refetches.
+  static const long firstInstallDate = base::android::SysUtils::FirstInstallDateFromJni();
   resource_request->url = net::AppendOrReplaceQueryParameter(resource_request->url, "install_date", base::NumberToString(firstInstallDate));
   int searchVersion = prefs_->GetInteger(prefs::kSearchProviderOverridesVersion);
   resource_request->url = net::AppendOrReplaceQueryParameter(resource_request->url, "settings_version", std::to_string(searchVersion));
-  std::string referrerString = base::android::SysUtils::ReferrerStringFromJni();
-  resource_request->url = net::AppendOrReplaceQueryParameter(resource_request->url, "ref", referrerString);
-
-  LOG(INFO) << "[Kiwi] List of search engines is requesting";
+  static const base::NoDestructor<std::string> referrerString(base::android::SysUtils::ReferrerStringFromJni());
+  resource_request->url = net::AppendOrReplaceQueryParameter(resource_request->url, "ref", *referrerString);
 
   resource_request->load_flags =
       (net::LOAD_DISABLE_CACHE | net::LOAD_DO_NOT_SAVE_COOKIES);
@@ -117,165 +136,118 @@ std::unique_ptr<network::SimpleURLLoader> SearchURLFetcher::CreateURLFetcher() {
 void SearchURLFetcher::OnURLLoadComplete(
     std::unique_ptr<std::string> response_body) {
   int version_code = -1;
-  int enable_server_suggestions = -1;
-
-  LOG(INFO) << "[Kiwi] We received response from SearchURLFetcher - A";
+  scoped_refptr<net::HttpResponseHeaders> headers =
+      url_loader_->ResponseInfo() ? url_loader_->ResponseInfo()->headers
+                                  : nullptr;
+  url_loader_.reset();
 
-  if (response_body)
-    LOG(INFO) << "[Kiwi] List of search engines returned with body";
-  else
-    LOG(INFO) << "[Kiwi] List of search engines returned without body";
   if (!response_body) {
-    LOG(INFO) << "[Kiwi] We received response from SearchURLFetcher - Empty response";
-    url_loader_.reset();
-    already_loaded_ = false;
+    LOG(INFO) << "[Kiwi] List of search engines returned without body";
     return;
   }
-  std::string body;
-  if (url_loader_->ResponseInfo() && url_loader_->ResponseInfo()->headers && url_loader_->ResponseInfo()->headers->HasHeader("se-version-code")) {
-    version_code = url_loader_->ResponseInfo()->headers->GetInt64HeaderValue("se-version-code");
-  } else {
-    // Delete the loader.
-    url_loader_.reset();
-    already_loaded_ = false;
+  if (!headers || !headers->HasHeader("se-version-code"))
     return;
-  }
-  body = std::move(*response_body);
-  LOG(INFO) << "[Kiwi] version_code: [" << version_code << "], response_body: [" << body.length() << "]";
-  LOG(INFO) << "[Kiwi] List of search engines returned with body:" << body;
+  version_code = headers->GetInt64HeaderValue("se-version-code");
+
+  const std::string& body = *response_body;
   if (!base::StartsWith(body, "{",
                         base::CompareCase::INSENSITIVE_ASCII)) {
     LOG(INFO) << "[Kiwi] Received invalid search-engines info with [" << body.length() << "]";
-    url_loader_.reset();
-    already_loaded_ = false;
     return;
   }
 
-  if (version_code != -1 && search_version_ != version_code && version_code > 0 && body.length() > 10) {
-    search_version_ = version_code;
-    LOG(INFO) << "[Kiwi] Received search-engines version: [" << version_code << "] settings from server-side: " << body.length() << " chars";
-
-    std::unique_ptr<base::DictionaryValue> master_dictionary_;
-
-    JSONStringValueDeserializer json(body);
-    std::string error;
-    std::unique_ptr<base::Value> root(json.Deserialize(NULL, &error));
-    if (!root.get()) {
-      LOG(ERROR) << "[Kiwi] Failed to parse brandcode prefs file: " << error;
-      url_loader_.reset();
-      already_loaded_ = false;
-      return;
-    }
-    if (!root->is_dict()) {
-      LOG(ERROR) << "[Kiwi] Failed to parse brandcode prefs file: "
-                 << "Root item must be a dictionary.";
-      url_loader_.reset();
-      already_loaded_ = false;
-      return;
-    }
-
-    const TemplateURL* default_search = template_url_service_->GetDefaultSearchProvider();
-    int current_default_search_prepopulated_id = 1;
-    std::u16string current_default_search_prepopulated_keyword = u"kiwi";
-    if (default_search)
-      current_default_search_prepopulated_id = default_search->prepopulate_id();
-    if (default_search)
-      current_default_search_prepopulated_keyword = default_search->keyword();
-
-    LOG(INFO) << "[Kiwi] search_url_fetcher - Trying to find template for search engine keyword: " << current_default_search_prepopulated_keyword;
-    TemplateURL *t = template_url_service_->FindPrepopulatedTemplateURLByKeyword(current_default_search_prepopulated_keyword);
-    if (!t) {
-      LOG(INFO) << "[Kiwi] search_url_fetcher - Trying to find template for search engine : " << current_default_search_prepopulated_id;
-      t = template_url_service_->FindPrepopulatedTemplateURL(current_default_search_prepopulated_id);
-    }
-    if (!t) {
-      LOG(INFO) << "[Kiwi] search_url_fetcher - Template not found, trying to find template for search engine ID 1";
-      t = template_url_service_->FindPrepopulatedTemplateURL(1);
-    }
-    if (!t) {
-      LOG(INFO) << "[Kiwi] search_url_fetcher - Template not found, trying to find template for search engine keyword kiwi";
-      t = template_url_service_->FindPrepopulatedTemplateURLByKeyword(u"kiwi");
-    }
-    if (!t) {
-      LOG(ERROR) << "[Kiwi] search_url_fetcher - Error, cannot find default template";
-      return ;
-    }
-    const TemplateURLData *new_dse = &(t->data());
-    if (!new_dse) {
-      LOG(ERROR) << "[Kiwi] search_url_fetcher - Error, cannot find new dse";
-      return ;
-    }
-    std::unique_ptr<base::DictionaryValue> saved_dse = TemplateURLDataToDictionary(*new_dse);
-
-    master_dictionary_.reset(
-        static_cast<base::DictionaryValue*>(root.release()));
-
-    const base::ListValue* value = NULL;
-    if (master_dictionary_ &&
-        master_dictionary_->GetList(prefs::kSearchProviderOverrides, &value) &&
-        value && value->GetSize() >= 2) {
-      LOG(INFO) << "[Kiwi] Search engine list contains " << value->GetSize() << " elements";
-
-      prefs_->ClearPref(prefs::kSearchProviderOverrides);
-      prefs_->SetInteger(prefs::kSearchProviderOverridesVersion,
-                                     -1);
-      prefs_->SetInteger(prefs::kLastKnownSearchVersion,
-                                     -1);
-      ListPrefUpdate update(prefs_, prefs::kSearchProviderOverrides);
-      base::ListValue* list = update.Get();
-      bool found_existing_search_engine = false;
-      bool success = false;
-      size_t num_engines = value->GetSize();
-      for (size_t i = 0; i != num_engines; ++i) {
-        const base::DictionaryValue* engine;
-        if (value->GetDictionary(i, &engine)) {
-          success = true;
-          std::u16string name;
-          engine->GetString("name", &name);
-          std::u16string keyword;
-          engine->GetString("keyword", &keyword);
-          LOG(INFO) << "[Kiwi] Adding to the list one search engine: " << engine << " is " << name << " (keyword: " << keyword << ")";
-          if (keyword == new_dse->keyword())
-            found_existing_search_engine = true;
-          list->Append(engine->CreateDeepCopy());
-        }
-      }
-
-      if (found_existing_search_engine || new_dse->id == 1 || new_dse->prepopulate_id == 1) {
-        LOG(INFO) << "[Kiwi] Search engine " << new_dse->keyword() << " was already present";
-      } else {
-        LOG(INFO) << "[Kiwi] Search engine " << new_dse->keyword() << " was not already present";
-        list->Append(saved_dse->CreateDeepCopy());
-      }
-
-      if (success) {
-        LOG(INFO) << "[Kiwi] Search engines processing is a success";
-        prefs_->SetInteger(prefs::kSearchProviderOverridesVersion,
-                                       version_code);
-        prefs_->SetInteger(prefs::kLastKnownSearchVersion,
-                                       version_code);
-        template_url_service_->SearchEnginesChanged();
-      } else {
-        LOG(ERROR) << "[Kiwi] Failure, no search engine found";
-      }
-      url_loader_.reset();
-      already_loaded_ = false;
-      return ;
-    }
+  // The server answered for the version we sent as settings_version, so the
+  // catalog stored in prefs is current: there is nothing to parse or merge.
+  if (version_code <= 0 || search_version_ == version_code || body.length() <= 10) {
+    already_loaded_ = true;
+    return;
+  }
+
+  LOG(INFO) << "[Kiwi] Received search-engines version: [" << version_code << "] settings from server-side: " << body.length() << " chars";
+
+  JSONStringValueDeserializer json(body);
+  std::string error;
+  std::unique_ptr<base::Value> root(json.Deserialize(NULL, &error));
+  if (!root.get()) {
+    LOG(ERROR) << "[Kiwi] Failed to parse brandcode prefs file: " << error;
+    return;
+  }
+  if (!root->is_dict()) {
+    LOG(ERROR) << "[Kiwi] Failed to parse brandcode prefs file: "
+               << "Root item must be a dictionary.";
+    return;
+  }
+
+  const TemplateURL* default_search = template_url_service_->GetDefaultSearchProvider();
+  int current_default_search_prepopulated_id = 1;
+  std::u16string current_default_search_prepopulated_keyword = u"kiwi";
+  if (default_search)
+    current_default_search_prepopulated_id = default_search->prepopulate_id();
+  if (default_search)
+    current_default_search_prepopulated_keyword = default_search->keyword();
+
+  TemplateURL *t = template_url_service_->FindPrepopulatedTemplateURLByKeyword(current_default_search_prepopulated_keyword);
+  if (!t)
+    t = template_url_service_->FindPrepopulatedTemplateURL(current_default_search_prepopulated_id);
+  if (!t)
+    t = template_url_service_->FindPrepopulatedTemplateURL(1);
+  if (!t)
+    t = template_url_service_->FindPrepopulatedTemplateURLByKeyword(u"kiwi");
+  if (!t) {
+    LOG(ERROR) << "[Kiwi] search_url_fetcher - Error, cannot find default template";
+    return ;
+  }
+  const TemplateURLData *new_dse = &(t->data());
+
+  const base::ListValue* value = NULL;
+  if (!static_cast<base::DictionaryValue*>(root.get())->GetList(prefs::kSearchProviderOverrides, &value) ||
+      !value || value->GetSize() < 2) {
     LOG(ERROR) << "[Kiwi] Failed to parse search-engines JSON";
-  } else {
-    LOG(INFO) << "[Kiwi] Received search-engines [" << version_code << "] settings from server-side: " << body.length() << " chars but we already have it";
+    return;
   }
-  url_loader_.reset();
-  already_loaded_ = false;
+
+  base::ListValue list;
+  bool found_existing_search_engine = false;
+  for (const base::Value& engine : value->GetList()) {
+    if (!engine.is_dict())
+      continue;
+    const std::string* keyword = engine.FindStringKey("keyword");
+    if (keyword && base::UTF8ToUTF16(*keyword) == new_dse->keyword())
+      found_existing_search_engine = true;
+    list.Append(engine.Clone());
+  }
+  if (list.GetList().empty()) {
+    LOG(ERROR) << "[Kiwi] Failure, no search engine found";
+    return;
+  }
+
+  // Keep the current default search engine available.
+  if (!found_existing_search_engine && new_dse->id != 1 && new_dse->prepopulate_id != 1)
+    list.Append(base::Value::FromUniquePtrValue(TemplateURLDataToDictionary(*new_dse)));
+
+  // A new version often only bumps the version number. TemplateURLService
+  // rebuilds every prepopulated engine from the overrides, so it is only
+  // told about the overrides when they actually changed.
+  const bool overrides_changed =
+      *prefs_->GetList(prefs::kSearchProviderOverrides) != list;
+  if (overrides_changed)
+    prefs_->Set(prefs::kSearchProviderOverrides, list);
+  prefs_->SetInteger(prefs::kSearchProviderOverridesVersion, version_code);
+  prefs_->SetInteger(prefs::kLastKnownSearchVersion, version_code);
+  search_version_ = version_code;
+  already_loaded_ = true;
+  LOG(INFO) << "[Kiwi] Search engines processing is a success, " << list.GetList().size() << " engines" << (overrides_changed ? "" : " (unchanged)");
+  if (overrides_changed)
+    template_url_service_->SearchEnginesChanged();
 }
 
 void SearchURLFetcher::OnNetworkChanged(net::NetworkChangeNotifier::ConnectionType type) {
-  // Ignore destructive signals.
-  LOG(INFO) << "[Kiwi] SearchURLFetcher::OnNetworkChanged";
-  if (type == net::NetworkChangeNotifier::CONNECTION_NONE)
+  // Ignore destructive signals, and reconnections once the catalog was
+  // fetched this run. A request in flight retries on its own.
+  if (type == net::NetworkChangeNotifier::CONNECTION_NONE || already_loaded_ ||
+      url_loader_)
     return;
-  already_loaded_ = false;
-  url_loader_.reset();
-  FetchURL();
+  // Flaky networks send bursts of changes; only fetch once they settle.
+  network_change_timer_.Start(FROM_HERE, kNetworkChangeFetchDelay, this,
+                              &SearchURLFetcher::FetchURL);
 }
@@ -11,6 +11,8 @@
 #include "components/prefs/pref_service.h"
 #include "components/search_engines/template_url_service.h"
 #include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
 #include "net/base/network_change_notifier.h"
 
 namespace network {
@@ -56,9 +58,12 @@ class SearchURLFetcher
  private:
   PrefService* prefs_;
   TemplateURLService* template_url_service_;
-  int search_version_;
-  bool already_loaded_;    // True if we've already loaded a URL once this run;
-                           // we won't load again until after a restart.
+  int search_version_ = -1;
+  bool already_loaded_ = false;  // True if we've already loaded a URL once this
+                                 // run; we won't load again until after a
+                                 // restart.
+  // Delays the fetch after a network change until the network settles.
+  base::OneShotTimer network_change_timer_;
   int search_version() const { return search_version_; }
 
   void OnURLLoadComplete(std::unique_ptr<std::string> response_body);
@@ -67,6 +72,8 @@ class SearchURLFetcher
   static const char kSearchDomainCheckURL[];
   std::unique_ptr<network::SimpleURLLoader> url_loader_;
   scoped_refptr<network::SharedURLLoaderFactory> url_loader_factory_;
+
+  base::WeakPtrFactory<SearchURLFetcher> weak_ptr_factory_{this};
 };
 
 #endif  // COMPONENTS_SEARCH_CORE_DISTILLER_URL_FETCHER_H_
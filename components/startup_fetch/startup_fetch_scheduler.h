@@ -0,0 +1,117 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_STARTUP_FETCH_STARTUP_FETCH_SCHEDULER_H_
+#define COMPONENTS_STARTUP_FETCH_STARTUP_FETCH_SCHEDULER_H_
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/no_destructor.h"
+#include "base/sequence_checker.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/time.h"
+#include "base/timer/elapsed_timer.h"
+#include "base/timer/timer.h"
+
+// Holds back the non-critical network fetches that services start while the
+// browser is starting up (the search engine catalog, the popular sites list,
+// ...), so that they do not compete with the first navigation for the network
+// and the UI thread. Fetches scheduled during startup are run once it is
+// over, highest priority first, a few at a time: each slot runs tasks until
+// they used up kSlotBudget of the UI thread, then yields for kSlotSpacing.
+// Fetches scheduled after startup run right away.
+//
+// Startup is over when NotifyStartupComplete() is called (the browser does
+// so once AfterStartupTaskUtils reports startup complete), or kStartupTimeout
+// after the first fetch was scheduled, whichever comes first. UI thread only.
+// Depends on base only, so that any component can defer its fetches.
+class StartupFetchScheduler {
+ public:
+  enum class Priority {
+    kLow,
+    kHigh,
+  };
+
+  static StartupFetchScheduler& Get() {
+    static base::NoDestructor<StartupFetchScheduler> instance;
+    return *instance;
+  }
+
+  StartupFetchScheduler(const StartupFetchScheduler&) = delete;
+  StartupFetchScheduler& operator=(const StartupFetchScheduler&) = delete;
+
+  // Runs |task| now if startup is over, else once it is. Bind |task| to a
+  // weak pointer if its receiver may go away before then.
+  void Schedule(Priority priority, base::OnceClosure task) {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    if (startup_complete_ && pending_.empty()) {
+      std::move(task).Run();
+      return;
+    }
+    pending_.emplace_back(priority, std::move(task));
+    if (!startup_complete_ && !startup_timer_.IsRunning()) {
+      startup_timer_.Start(FROM_HERE, kStartupTimeout, this,
+                           &StartupFetchScheduler::NotifyStartupComplete);
+    }
+  }
+
+  void NotifyStartupComplete() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    if (startup_complete_)
+      return;
+    startup_complete_ = true;
+    startup_timer_.Stop();
+    RunSlot();
+  }
+
+  bool startup_complete() const { return startup_complete_; }
+
+ private:
+  friend class base::NoDestructor<StartupFetchScheduler>;
+
+  static constexpr base::TimeDelta kStartupTimeout =
+      base::TimeDelta::FromSeconds(10);
+  static constexpr base::TimeDelta kSlotBudget =
+      base::TimeDelta::FromMilliseconds(8);
+  static constexpr base::TimeDelta kSlotSpacing =
+      base::TimeDelta::FromMilliseconds(500);
+
+  StartupFetchScheduler() = default;
+  ~StartupFetchScheduler() = default;
+
+  void RunSlot() {
+    DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+    base::ElapsedTimer slot;
+    while (!pending_.empty() && slot.Elapsed() < kSlotBudget) {
+      // Oldest of the highest priority tasks; there are only a few of them.
+      auto next = pending_.begin();
+      for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        if (it->first > next->first)
+          next = it;
+      }
+      base::OnceClosure task = std::move(next->second);
+      pending_.erase(next);
+      std::move(task).Run();
+    }
+    if (!pending_.empty()) {
+      base::SequencedTaskRunnerHandle::Get()->PostDelayedTask(
+          FROM_HERE,
+          base::BindOnce(&StartupFetchScheduler::RunSlot,
+                         base::Unretained(this)),
+          kSlotSpacing);
+    }
+  }
+
+  bool startup_complete_ = false;
+  std::vector<std::pair<Priority, base::OnceClosure>> pending_;
+  base::OneShotTimer startup_timer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+#endif  // COMPONENTS_STARTUP_FETCH_STARTUP_FETCH_SCHEDULER_H_
@@ -8,15 +8,21 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/cxx17_backports.h"
 #include "base/feature_list.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
 #include "base/logging.h"
 #include "base/metrics/field_trial.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/system/sys_info.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -74,6 +80,120 @@ struct GpuFeatureData {
   bool fallback_to_software;
 };
 
+#if defined(OS_ANDROID)
+// Returns the ids of the CPUs that may ever be online, from a list of ranges
+// such as "0-3,6,8-9". NumberOfProcessors() only counts the ones that are
+// online now, which leaves out big cores that are hotplugged off.
+std::vector<int> GetPossibleCpus() {
+  std::vector<int> cpus;
+  std::string contents;
+  if (!base::ReadFileToStringNonBlocking(
+          base::FilePath("/sys/devices/system/cpu/possible"), &contents)) {
+    return cpus;
+  }
+  for (base::StringPiece range : base::SplitStringPiece(
+           contents, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<base::StringPiece> bounds = base::SplitStringPiece(
+        range, "-", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    int first = 0;
+    int last = 0;
+    if (bounds.empty() || bounds.size() > 2 ||
+        !base::StringToInt(bounds.front(), &first) ||
+        !base::StringToInt(bounds.back(), &last) || first < 0 ||
+        last < first) {
+      return std::vector<int>();
+    }
+    for (int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// Returns the number of "big" cores: those faster than the slowest cluster,
+// going by their maximum frequency in cpufreq, or all of them if they are
+// all alike. Returns 0 if the topology cannot be read. Phones commonly pair
+// 2 to 4 big (or big and prime) cores with as many little ones. All the
+// possible CPUs are looked at, not only the online ones: the cpufreq policy
+// of an offline core is still readable on current kernels, so the count does
+// not depend on which cores are online when it is first computed.
+int NumberOfBigCores() {
+  static const int big_cores = [] {
+    std::vector<int64_t> max_freqs;
+    for (int cpu : GetPossibleCpus()) {
+      std::string contents;
+      int64_t max_freq = 0;
+      // sysfs reads do not block, and the result is computed once.
+      if (!base::ReadFileToStringNonBlocking(
+              base::FilePath(base::StringPrintf(
+                  "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq",
+                  cpu)),
+              &contents) ||
+          !base::StringToInt64(
+              base::TrimWhitespaceASCII(contents, base::TRIM_ALL),
+              &max_freq)) {
+        continue;
+      }
+      max_freqs.push_back(max_freq);
+    }
+    if (max_freqs.empty())
+      return 0;
+    const int64_t slowest =
+        *std::min_element(max_freqs.begin(), max_freqs.end());
+    const int faster = static_cast<int>(
+        std::count_if(max_freqs.begin(), max_freqs.end(),
+                      [slowest](int64_t freq) { return freq > slowest; }));
+    return faster ? faster : static_cast<int>(max_freqs.size());
+  }();
+  return big_cores;
+}
+
+// Lets phones with several big cores use more than one raster thread. Off
+// until its effect on jank and power has been measured.
+const base::Feature kBigCoreRasterThreads{"BigCoreRasterThreads",
+                                          base::FEATURE_DISABLED_BY_DEFAULT};
+
+// Gives low-end devices compositor resource settings that use less memory
+// instead of the same defaults as every other device. Off until its effect on
+// raster quality and memory has been measured.
+const base::Feature kDeviceClassCompositorProfile{
+    "DeviceClassCompositorProfile", base::FEATURE_DISABLED_BY_DEFAULT};
+#endif  // defined(OS_ANDROID)
+
+// Compositor resource settings used when they are not set on the command
+// line.
+struct CompositorProfile {
+  const char* name;
+  bool zero_copy_upload;
+  bool gpu_memory_buffer_resources;
+  int msaa_sample_count;
+};
+
+const CompositorProfile& GetCompositorProfile() {
+#if defined(OS_ANDROID)
+  // Zero-copy and GpuMemoryBuffer resources need native buffers that raster
+  // cannot use on Android, so only MSAA differs: it multiplies the memory of
+  // every GPU-rastered tile, which low-end devices cannot spare.
+  static constexpr CompositorProfile kLowEnd = {"low_end", false, false, 0};
+  static constexpr CompositorProfile kDefault = {"default", false, false, 4};
+  // Device characteristics do not change while the browser runs.
+  static const CompositorProfile* const profile = []() {
+    if (base::FeatureList::IsEnabled(kDeviceClassCompositorProfile) &&
+        base::SysInfo::IsLowEndDevice()) {
+      return &kLowEnd;
+    }
+    return &kDefault;
+  }();
+  return *profile;
+#elif defined(OS_MAC)
+  static constexpr CompositorProfile kDefault = {"default", true, true, -1};
+  return kDefault;
+#else
+  // Desktop platforms compute the MSAA sample count from the DPI.
+  static constexpr CompositorProfile kDefault = {"default", false, false, -1};
+  return kDefault;
+#endif
+}
+
 gpu::GpuFeatureStatus SafeGetFeatureStatus(
     const gpu::GpuFeatureInfo& gpu_feature_info,
     gpu::GpuFeatureType feature) {
@@ -263,6 +383,8 @@ base::Value GetFeatureStatusImpl(GpuFeatureInfoType type) {
     }
     feature_status_dict.SetStringKey(gpu_feature_data.name, status);
   }
+  feature_status_dict.SetStringKey("compositor_profile",
+                                   GetCompositorProfile().name);
   return feature_status_dict;
 }
 
@@ -383,6 +505,14 @@ int NumberOfRendererRasterThreads() {
   // TODO(reveman): Remove this when we have a better mechanims to prevent
   // pre-paint raster work from slowing down non-raster work. crbug.com/504515
   num_raster_threads = 1;
+
+  // Devices with at least 4 big cores have enough of them for a second raster
+  // thread to not compete with the main and compositor threads. Low-end
+  // devices keep a single thread to save memory.
+  if (base::FeatureList::IsEnabled(kBigCoreRasterThreads) &&
+      !base::SysInfo::IsLowEndDevice()) {
+    num_raster_threads = base::clamp(NumberOfBigCores() / 2, 1, 2);
+  }
 #endif
 
   const base::CommandLine& command_line =
@@ -403,11 +533,11 @@ int NumberOfRendererRasterThreads() {
 bool IsZeroCopyUploadEnabled() {
   const base::CommandLine& command_line =
       *base::CommandLine::ForCurrentProcess();
-#if defined(OS_MAC)
-  return !command_line.HasSwitch(blink::switches::kDisableZeroCopy);
-#else
-  return command_line.HasSwitch(blink::switches::kEnableZeroCopy);
-#endif
+  if (command_line.HasSwitch(blink::switches::kEnableZeroCopy))
+    return true;
+  if (command_line.HasSwitch(blink::switches::kDisableZeroCopy))
+    return false;
+  return GetCompositorProfile().zero_copy_upload;
 }
 
 bool IsPartialRasterEnabled() {
@@ -429,11 +559,7 @@ bool IsGpuMemoryBufferCompositorResourcesEnabled() {
     return false;
   }
 
-#if defined(OS_MAC)
-  return true;
-#else
-  return false;
-#endif
+  return GetCompositorProfile().gpu_memory_buffer_resources;
 }
 
 int GpuRasterizationMSAASampleCount() {
@@ -441,13 +567,9 @@ int GpuRasterizationMSAASampleCount() {
       *base::CommandLine::ForCurrentProcess();
 
   if (!command_line.HasSwitch(
-          blink::switches::kGpuRasterizationMSAASampleCount))
-#if defined(OS_ANDROID)
-    return 4;
-#else
-    // Desktop platforms will compute this automatically based on DPI.
-    return -1;
-#endif
+          blink::switches::kGpuRasterizationMSAASampleCount)) {
+    return GetCompositorProfile().msaa_sample_count;
+  }
   std::string string_value = command_line.GetSwitchValueASCII(
       blink::switches::kGpuRasterizationMSAASampleCount);
   int msaa_sample_count = 0;
@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/containers/contains.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
 #include "base/path_service.h"
 #include "base/strings/string_util.h"
@@ -58,6 +59,21 @@ absl::optional<std::string> ReadFileContent(const base::FilePath& path) {
                                                 : absl::optional<std::string>();
 }
 
+// Themes may only contain the file types ZipFileInstaller::ShouldExtractFile()
+// allows for them. The archive is unzipped before the manifest says whether
+// it is a theme, so the other files are removed afterwards.
+bool RemoveFilesNotAllowedInTheme(const base::FilePath& unzip_dir) {
+  base::FileEnumerator files(unzip_dir, /*recursive=*/true,
+                             base::FileEnumerator::FILES);
+  for (base::FilePath file = files.Next(); !file.empty(); file = files.Next()) {
+    if (!ZipFileInstaller::ShouldExtractFile(/*is_theme=*/true, file) &&
+        !base::DeleteFile(file)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 // static
@@ -115,9 +131,16 @@ void ZipFileInstaller::Unzip(absl::optional<base::FilePath> unzip_dir) {
     return;
   }
 
+  // The whole archive is extracted in this one pass; the manifest is read
+  // from the extracted files. IsManifestFile() also records which directory
+  // holds the manifest.
   unzip::UnzipWithFilter(
       unzip::LaunchUnzipper(), zip_file_, *unzip_dir,
-      base::BindRepeating(&ZipFileInstaller::IsManifestFile),
+      base::BindRepeating([](const base::FilePath& file_path) -> bool {
+        ZipFileInstaller::IsManifestFile(file_path);
+        return ZipFileInstaller::ShouldExtractFile(/*is_theme=*/false,
+                                                   file_path);
+      }),
       base::BindOnce(&ZipFileInstaller::ManifestUnzipped, this, *unzip_dir));
 }
 
@@ -170,20 +193,16 @@ void ZipFileInstaller::ManifestParsed(
 
   Manifest::Type manifest_type =
       Manifest::GetTypeFromManifestValue(*manifest_dictionary);
-
-  unzip::UnzipFilterCallback filter = base::BindRepeating(
-      [](bool is_theme, const base::FilePath& file_path) -> bool {
-        // Note that we ignore the manifest as it has already been extracted and
-        // would cause the unzipping to fail.
-        return ZipFileInstaller::ShouldExtractFile(is_theme, file_path) &&
-               !ZipFileInstaller::IsManifestFile(file_path);
-      },
-      manifest_type == Manifest::TYPE_THEME);
+  if (manifest_type != Manifest::TYPE_THEME) {
+    UnzipDone(unzip_dir, /*success=*/true);
+    return;
+  }
 
   // TODO(crbug.com/645263): This silently ignores blocked file types.
   //                         Add install warnings.
-  unzip::UnzipWithFilter(
-      unzip::LaunchUnzipper(), zip_file_, unzip_dir, filter,
+  base::PostTaskAndReplyWithResult(
+      io_task_runner_.get(), FROM_HERE,
+      base::BindOnce(&RemoveFilesNotAllowedInTheme, unzip_dir),
       base::BindOnce(&ZipFileInstaller::UnzipDone, this, unzip_dir));
 }
 
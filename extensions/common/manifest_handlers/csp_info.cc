@@ -5,12 +5,18 @@
 #include "extensions/common/manifest_handlers/csp_info.h"
 
 #include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/no_destructor.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "base/values.h"
 #include "extensions/common/csp_validator.h"
 #include "extensions/common/error_utils.h"
@@ -103,6 +109,90 @@ const char* GetDefaultExtensionPagesCSP(Extension* extension,
   return kDefaultContentSecurityPolicy;
 }
 
+// Remembers the result of sanitizing a CSP string. The same manifests are
+// parsed over and over in a process: when extensions are loaded at startup,
+// reloaded or updated, and in every renderer that receives them. Most of them
+// also share one of a handful of CSPs, so the same strings would otherwise be
+// tokenized and sanitized again each time.
+class SanitizedCSPCache {
+ public:
+  enum class Kind { kExtensionPages, kSandbox };
+
+  static SanitizedCSPCache& Get() {
+    static base::NoDestructor<SanitizedCSPCache> cache;
+    return *cache;
+  }
+
+  SanitizedCSPCache(const SanitizedCSPCache&) = delete;
+  SanitizedCSPCache& operator=(const SanitizedCSPCache&) = delete;
+
+  // Returns the sanitized |policy| and adds the warnings sanitizing it gave
+  // to |warnings|. |options| is only used for kExtensionPages.
+  std::string Sanitize(Kind kind,
+                       const std::string& policy,
+                       base::StringPiece manifest_key,
+                       int options,
+                       std::vector<InstallWarning>* warnings) {
+    Key key(kind, options, std::string(manifest_key), policy);
+    {
+      base::AutoLock lock(lock_);
+      auto it = cache_.Get(key);
+      if (it != cache_.end())
+        return it->second.ToResult(warnings);
+    }
+
+    std::vector<InstallWarning> new_warnings;
+    std::string sanitized =
+        kind == Kind::kExtensionPages
+            ? SanitizeContentSecurityPolicy(policy, std::get<2>(key), options,
+                                            &new_warnings)
+            : csp_validator::GetEffectiveSandoxedPageCSP(
+                  policy, std::get<2>(key), &new_warnings);
+    Entry entry(sanitized, new_warnings);
+    for (InstallWarning& warning : new_warnings)
+      warnings->push_back(std::move(warning));
+
+    base::AutoLock lock(lock_);
+    cache_.Put(std::move(key), std::move(entry));
+    return sanitized;
+  }
+
+ private:
+  friend class base::NoDestructor<SanitizedCSPCache>;
+
+  using Key = std::tuple<Kind, int, std::string, std::string>;
+
+  // InstallWarning is move-only, so the warnings are kept as their fields.
+  struct Entry {
+    Entry(const std::string& policy,
+          const std::vector<InstallWarning>& install_warnings)
+        : policy(policy) {
+      for (const InstallWarning& warning : install_warnings)
+        warnings.emplace_back(warning.message, warning.key, warning.specific);
+    }
+
+    std::string ToResult(std::vector<InstallWarning>* install_warnings) const {
+      for (const auto& warning : warnings) {
+        install_warnings->emplace_back(std::get<0>(warning),
+                                       std::get<1>(warning),
+                                       std::get<2>(warning));
+      }
+      return policy;
+    }
+
+    std::string policy;
+    std::vector<std::tuple<std::string, std::string, std::string>> warnings;
+  };
+
+  static constexpr size_t kMaxEntries = 256;
+
+  SanitizedCSPCache() : cache_(kMaxEntries) {}
+  ~SanitizedCSPCache() = default;
+
+  base::Lock lock_;
+  base::MRUCache<Key, Entry> cache_ GUARDED_BY(lock_);
+};
+
 }  // namespace
 
 CSPInfo::CSPInfo(std::string extension_pages_csp)
@@ -277,9 +367,11 @@ bool CSPHandler::ParseExtensionPagesCSP(
   }
 
   std::vector<InstallWarning> warnings;
-  std::string sanitized_content_security_policy = SanitizeContentSecurityPolicy(
-      content_security_policy_str, std::string(manifest_key),
-      GetValidatorOptions(extension), &warnings);
+  std::string sanitized_content_security_policy =
+      SanitizedCSPCache::Get().Sanitize(
+          SanitizedCSPCache::Kind::kExtensionPages,
+          content_security_policy_str, manifest_key,
+          GetValidatorOptions(extension), &warnings);
   extension->AddInstallWarnings(std::move(warnings));
 
   SetExtensionPagesCSP(extension, manifest_key, secure_only,
@@ -310,9 +402,9 @@ bool CSPHandler::ParseSandboxCSP(Extension* extension,
   }
 
   std::vector<InstallWarning> warnings;
-  std::string effective_sandbox_csp =
-      csp_validator::GetEffectiveSandoxedPageCSP(
-          sandbox_csp_str, std::string(manifest_key), &warnings);
+  std::string effective_sandbox_csp = SanitizedCSPCache::Get().Sanitize(
+      SanitizedCSPCache::Kind::kSandbox, sandbox_csp_str, manifest_key,
+      csp_validator::OPTIONS_NONE, &warnings);
   SetSandboxCSP(extension, std::move(effective_sandbox_csp));
   extension->AddInstallWarnings(std::move(warnings));
   return true;
@@ -119,6 +119,18 @@ base::StringPiece StripTrailingWildcard(base::StringPiece path) {
   return path;
 }
 
+// Returns GURL::PathForRequest() of |url| without copying it: the path and
+// query are contiguous in the spec. |url| must be valid and have a path.
+base::StringPiece PathForRequestPiece(const GURL& url) {
+  const std::string& spec = url.spec();
+  const url::Parsed& parsed = url.parsed_for_possibly_invalid_spec();
+  DCHECK(parsed.path.is_nonempty());
+  const size_t end =
+      parsed.ref.is_valid() ? parsed.ref.begin - 1 : spec.size();
+  return base::StringPiece(spec).substr(parsed.path.begin,
+                                        end - parsed.path.begin);
+}
+
 // Removes trailing dot from |host_piece| if any.
 base::StringPiece CanonicalizeHostForMatching(base::StringPiece host_piece) {
   if (base::EndsWith(host_piece, "."))
@@ -401,6 +413,16 @@ void URLPattern::SetPath(base::StringPiece path) {
   path_escaped_ = path_;
   base::ReplaceSubstringsAfterOffset(&path_escaped_, 0, "\\", "\\\\");
   base::ReplaceSubstringsAfterOffset(&path_escaped_, 0, "?", "\\?");
+
+  // Paths without escapes and whose only wildcard, if any, is a trailing '*'
+  // (nearly all of them) are matched with plain comparisons.
+  const size_t special = path_.find_first_of("*?\\");
+  if (special == std::string::npos)
+    path_kind_ = PathKind::kExact;
+  else if (special == path_.size() - 1 && path_[special] == '*')
+    path_kind_ = PathKind::kPrefix;
+  else
+    path_kind_ = PathKind::kGlob;
 }
 
 bool URLPattern::SetPort(base::StringPiece port) {
@@ -439,14 +461,14 @@ bool URLPattern::MatchesURL(const GURL& test) const {
   if (!test.has_path())
     return false;
 
-  std::string path_for_request = test.PathForRequest();
-  if (has_inner_url) {
-    path_for_request = base::StringPrintf("%s%s", test_url->path_piece().data(),
-                                          path_for_request.c_str());
-  }
+  if (!MatchesSecurityOriginHelper(*test_url))
+    return false;
 
-  return MatchesSecurityOriginHelper(*test_url) &&
-         MatchesPath(path_for_request);
+  const base::StringPiece path_for_request = PathForRequestPiece(test);
+  if (has_inner_url)
+    return MatchesPath(
+        base::StrCat({test_url->path_piece(), path_for_request}));
+  return MatchesPath(path_for_request);
 }
 
 bool URLPattern::MatchesSecurityOrigin(const GURL& test) const {
@@ -554,6 +576,21 @@ bool URLPattern::MatchesSingleOrigin() const {
 }
 
 bool URLPattern::MatchesPath(base::StringPiece test) const {
+  switch (path_kind_) {
+    case PathKind::kExact:
+      return test == path_;
+    case PathKind::kPrefix: {
+      const base::StringPiece prefix(path_.data(), path_.size() - 1);
+      if (base::StartsWith(test, prefix))
+        return true;
+      // Same special case as below: "/foo/*" also matches "/foo".
+      return prefix.size() == test.size() + 1 && prefix.back() == '/' &&
+             base::StartsWith(prefix, test);
+    }
+    case PathKind::kGlob:
+      break;
+  }
+
   // Make the behaviour of OverlapsWith consistent with MatchesURL, which is
   // need to match hosted apps on e.g. 'google.com' also run on 'google.com/'.
   // The below if is a no-copy way of doing (test + "/*" == path_escaped_).
@@ -756,8 +793,10 @@ bool URLPattern::MatchesSecurityOriginHelper(const GURL& test) const {
   if (scheme_ != url::kFileScheme && !MatchesHost(test))
     return false;
 
-  if (!MatchesPortPattern(base::NumberToString(test.EffectiveIntPort())))
+  if (port_ != "*" &&
+      !MatchesPortPattern(base::NumberToString(test.EffectiveIntPort()))) {
     return false;
+  }
 
   return true;
 }
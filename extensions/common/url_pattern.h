@@ -294,6 +294,17 @@ class URLPattern {
   // MatchPattern() function.
   std::string path_escaped_;
 
+  // How MatchesPath() compares against |path_|, set by SetPath().
+  enum class PathKind {
+    // No wildcard: |path_| must equal the path.
+    kExact,
+    // A single trailing '*': |path_| without it must be a prefix.
+    kPrefix,
+    // Anything else goes through MatchPattern() with |path_escaped_|.
+    kGlob,
+  };
+  PathKind path_kind_ = PathKind::kGlob;
+
   // A string representing this URLPattern.
   mutable std::string spec_;
 };
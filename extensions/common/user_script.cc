@@ -15,6 +15,7 @@
 #include "base/pickle.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "extensions/common/switches.h"
 
@@ -24,10 +25,53 @@ namespace {
 // from multiple threads.
 base::AtomicSequenceNumber g_user_script_id_generator;
 
+// Matches |text| against a glob whose only wildcard is '*', in one pass: the
+// literal runs between the stars must appear in order, the first one at the
+// start and the last one at the end. Same result as base::MatchPattern() for
+// such globs, without its backtracking.
+bool MatchesStarGlob(base::StringPiece text, base::StringPiece glob) {
+  const size_t first_star = glob.find('*');
+  if (first_star == base::StringPiece::npos)
+    return text == glob;
+  const size_t last_star = glob.rfind('*');
+
+  const base::StringPiece first = glob.substr(0, first_star);
+  const base::StringPiece last = glob.substr(last_star + 1);
+  if (text.size() < first.size() + last.size() ||
+      !base::StartsWith(text, first) || !base::EndsWith(text, last)) {
+    return false;
+  }
+  text = text.substr(first.size(), text.size() - first.size() - last.size());
+
+  base::StringPiece middle =
+      glob.substr(first_star + 1, last_star - first_star - 1);
+  while (!middle.empty()) {
+    const size_t star = middle.find('*');
+    const base::StringPiece literal = middle.substr(0, star);
+    const size_t pos = text.find(literal);
+    if (pos == base::StringPiece::npos)
+      return false;
+    text.remove_prefix(pos + literal.size());
+    if (star == base::StringPiece::npos)
+      break;
+    middle.remove_prefix(star + 1);
+  }
+  return true;
+}
+
+bool UrlMatchesGlob(base::StringPiece spec, const std::string& glob) {
+  // '?' and escapes need base::MatchPattern(). Userscript @include globs
+  // almost never use them.
+  if (glob.find_first_of("?\\") == std::string::npos)
+    return MatchesStarGlob(spec, glob);
+  return base::MatchPattern(spec, glob);
+}
+
 bool UrlMatchesGlobs(const std::vector<std::string>* globs,
                      const GURL& url) {
+  const std::string& spec = url.spec();
   for (auto glob = globs->cbegin(); glob != globs->cend(); ++glob) {
-    if (base::MatchPattern(url.spec(), *glob))
+    if (UrlMatchesGlob(spec, *glob))
       return true;
   }
 
@@ -228,11 +272,20 @@ void UserScript::PickleHostID(base::Pickle* pickle,
 
 void UserScript::PickleURLPatternSet(base::Pickle* pickle,
                                      const URLPatternSet& pattern_list) const {
+  // The patterns are written already parsed, so that renderers do not parse
+  // and canonicalize every pattern of every script again.
   pickle->WriteUInt32(pattern_list.patterns().size());
   for (auto pattern = pattern_list.begin(); pattern != pattern_list.end();
        ++pattern) {
     pickle->WriteInt(pattern->valid_schemes());
-    pickle->WriteString(pattern->GetAsString());
+    pickle->WriteBool(pattern->match_all_urls());
+    if (pattern->match_all_urls())
+      continue;
+    pickle->WriteString(pattern->scheme());
+    pickle->WriteString(pattern->host());
+    pickle->WriteBool(pattern->match_subdomains());
+    pickle->WriteString(pattern->port());
+    pickle->WriteString(pattern->path());
   }
 }
 
@@ -287,10 +340,11 @@ void UserScript::UnpickleGlobs(const base::Pickle& pickle,
   uint32_t num_globs = 0;
   CHECK(iter->ReadUInt32(&num_globs));
   globs->clear();
+  globs->reserve(num_globs);
   for (uint32_t i = 0; i < num_globs; ++i) {
     std::string glob;
     CHECK(iter->ReadString(&glob));
-    globs->push_back(glob);
+    globs->push_back(std::move(glob));
   }
 }
 
@@ -315,14 +369,26 @@ void UserScript::UnpickleURLPatternSet(const base::Pickle& pickle,
     int valid_schemes;
     CHECK(iter->ReadInt(&valid_schemes));
 
-    std::string pattern_str;
-    CHECK(iter->ReadString(&pattern_str));
-
     URLPattern pattern(kValidUserScriptSchemes);
-    URLPattern::ParseResult result = pattern.Parse(pattern_str);
-    CHECK(URLPattern::ParseResult::kSuccess == result)
-        << URLPattern::GetParseResultString(result) << " "
-        << pattern_str.c_str();
+    bool match_all_urls = false;
+    CHECK(iter->ReadBool(&match_all_urls));
+    if (match_all_urls) {
+      pattern.SetMatchAllURLs(true);
+    } else {
+      // The host was canonicalized when the browser parsed the pattern.
+      base::StringPiece scheme, host, port, path;
+      bool match_subdomains = false;
+      CHECK(iter->ReadStringPiece(&scheme));
+      CHECK(iter->ReadStringPiece(&host));
+      CHECK(iter->ReadBool(&match_subdomains));
+      CHECK(iter->ReadStringPiece(&port));
+      CHECK(iter->ReadStringPiece(&path));
+      CHECK(pattern.SetScheme(scheme)) << scheme;
+      pattern.SetHost(host);
+      pattern.SetMatchSubdomains(match_subdomains);
+      CHECK(pattern.SetPort(port)) << port;
+      pattern.SetPath(path);
+    }
 
     pattern.SetValidSchemes(valid_schemes);
     pattern_list->AddPattern(pattern);
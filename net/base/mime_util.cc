@@ -7,12 +7,17 @@
 #include <map>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "base/base64.h"
 #include "base/check_op.h"
+#include "base/containers/flat_map.h"
 #include "base/containers/span.h"
 #include "base/lazy_instance.h"
+#include "base/no_destructor.h"
 #include "base/rand_util.h"
+#include "base/strings/strcat.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
@@ -222,28 +227,78 @@ static const MimeInfo kSecondaryMappings[] = {
     {"video/mpeg", "mpeg,mpg"},
 };
 
-// Finds mime type of |ext| from |mappings|.
-template <size_t num_mappings>
-static const char* FindMimeType(const MimeInfo (&mappings)[num_mappings],
-                                const std::string& ext) {
-  for (const auto& mapping : mappings) {
-    const char* extensions = mapping.extensions;
-    for (;;) {
-      size_t end_pos = strcspn(extensions, ",");
-      // The length check is required to prevent the StringPiece below from
-      // including uninitialized memory if ext is longer than extensions.
-      if (end_pos == ext.size() &&
-          base::EqualsCaseInsensitiveASCII(
-              base::StringPiece(extensions, ext.size()), ext)) {
-        return mapping.mime_type;
-      }
-      extensions += end_pos;
-      if (!*extensions)
-        break;
-      extensions += 1;  // skip over comma
+// Lookup tables over one of the MIME maps above, built on first use so that
+// the per-query cost is a binary search instead of a scan of every mapping
+// and of its comma-separated extension list. Immutable once built, so it can
+// be used from any thread.
+class MimeMappingIndex {
+ public:
+  explicit MimeMappingIndex(base::span<const MimeInfo> mappings) {
+    std::vector<std::pair<std::string, const char*>> types;
+    std::vector<std::pair<base::StringPiece, std::vector<base::StringPiece>>>
+        extensions;
+    for (const auto& mapping : mappings) {
+      DCHECK_EQ(base::ToLowerASCII(mapping.mime_type), mapping.mime_type);
+      std::vector<base::StringPiece> mapping_extensions =
+          base::SplitStringPiece(mapping.extensions, ",",
+                                 base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
+      for (base::StringPiece extension : mapping_extensions)
+        types.emplace_back(base::ToLowerASCII(extension), mapping.mime_type);
+      extensions.emplace_back(mapping.mime_type,
+                              std::move(mapping_extensions));
     }
+    // flat_map keeps the first of duplicate keys, so an extension that
+    // appears more than once maps to its first MIME type, as required above.
+    mime_type_by_extension_ = base::flat_map<std::string, const char*>(
+        std::move(types));
+    extensions_by_mime_type_ =
+        base::flat_map<base::StringPiece, std::vector<base::StringPiece>>(
+            std::move(extensions));
+  }
+
+  MimeMappingIndex(const MimeMappingIndex&) = delete;
+  MimeMappingIndex& operator=(const MimeMappingIndex&) = delete;
+
+  // Returns the MIME type of the lower-case extension |ext|, or nullptr.
+  const char* FindMimeType(base::StringPiece ext) const {
+    auto it = mime_type_by_extension_.find(ext);
+    return it != mime_type_by_extension_.end() ? it->second : nullptr;
+  }
+
+  // Returns the extensions of |mime_type|, preferred first, or nullptr.
+  const std::vector<base::StringPiece>* FindExtensions(
+      base::StringPiece mime_type) const {
+    auto it = extensions_by_mime_type_.find(mime_type);
+    return it != extensions_by_mime_type_.end() ? &it->second : nullptr;
   }
-  return nullptr;
+
+  // Calls |callback| with the extensions of every lower-case MIME type that
+  // starts with |prefix|. The keys are sorted, so those are adjacent.
+  template <typename Callback>
+  void ForEachMimeTypeWithPrefix(base::StringPiece prefix,
+                                 Callback callback) const {
+    for (auto it = extensions_by_mime_type_.lower_bound(prefix);
+         it != extensions_by_mime_type_.end() &&
+         base::StartsWith(it->first, prefix);
+         ++it) {
+      callback(it->second);
+    }
+  }
+
+ private:
+  base::flat_map<std::string, const char*> mime_type_by_extension_;
+  base::flat_map<base::StringPiece, std::vector<base::StringPiece>>
+      extensions_by_mime_type_;
+};
+
+static const MimeMappingIndex& PrimaryMappingIndex() {
+  static const base::NoDestructor<MimeMappingIndex> index(kPrimaryMappings);
+  return *index;
+}
+
+static const MimeMappingIndex& SecondaryMappingIndex() {
+  static const base::NoDestructor<MimeMappingIndex> index(kSecondaryMappings);
+  return *index;
 }
 
 static base::FilePath::StringType StringToFilePathStringType(
@@ -256,26 +311,20 @@ static base::FilePath::StringType StringToFilePathStringType(
 }
 
 // Helper used in MimeUtil::GetPreferredExtensionForMimeType() to search
-// preferred extension in MimeInfo arrays.
-template <size_t num_mappings>
-static bool FindPreferredExtension(const MimeInfo (&mappings)[num_mappings],
+// preferred extension in the MIME maps.
+static bool FindPreferredExtension(const MimeMappingIndex& index,
                                    const std::string& mime_type,
                                    base::FilePath::StringType* result) {
   // There is no preferred extension for "application/octet-stream".
   if (mime_type == "application/octet-stream")
     return false;
 
-  for (const auto& mapping : mappings) {
-    if (mapping.mime_type == mime_type) {
-      const char* extensions = mapping.extensions;
-      const char* extension_end = strchr(extensions, ',');
-      size_t len =
-          extension_end ? extension_end - extensions : strlen(extensions);
-      *result = StringToFilePathStringType(base::StringPiece(extensions, len));
-      return true;
-    }
-  }
-  return false;
+  const std::vector<base::StringPiece>* extensions =
+      index.FindExtensions(mime_type);
+  if (!extensions)
+    return false;
+  *result = StringToFilePathStringType(extensions->front());
+  return true;
 }
 
 bool MimeUtil::GetMimeTypeFromExtension(const base::FilePath::StringType& ext,
@@ -295,8 +344,8 @@ bool MimeUtil::GetPreferredExtensionForMimeType(
   // Search the MIME type in the platform DB first, then in kPrimaryMappings and
   // kSecondaryMappings.
   return GetPlatformPreferredExtensionForMimeType(mime_type, extension) ||
-         FindPreferredExtension(kPrimaryMappings, mime_type, extension) ||
-         FindPreferredExtension(kSecondaryMappings, mime_type, extension);
+         FindPreferredExtension(PrimaryMappingIndex(), mime_type, extension) ||
+         FindPreferredExtension(SecondaryMappingIndex(), mime_type, extension);
 }
 
 bool MimeUtil::GetMimeTypeFromFile(const base::FilePath& file_path,
@@ -337,8 +386,8 @@ bool MimeUtil::GetMimeTypeFromExtensionHelper(
   // deduce but that we also want to allow the OS to override.
 
   base::FilePath path_ext(ext);
-  const string ext_narrow_str = path_ext.AsUTF8Unsafe();
-  const char* mime_type = FindMimeType(kPrimaryMappings, ext_narrow_str);
+  const string ext_narrow_str = base::ToLowerASCII(path_ext.AsUTF8Unsafe());
+  const char* mime_type = PrimaryMappingIndex().FindMimeType(ext_narrow_str);
   if (mime_type) {
     *result = mime_type;
     return true;
@@ -347,7 +396,7 @@ bool MimeUtil::GetMimeTypeFromExtensionHelper(
   if (include_platform_types && GetPlatformMimeTypeFromExtension(ext, result))
     return true;
 
-  mime_type = FindMimeType(kSecondaryMappings, ext_narrow_str);
+  mime_type = SecondaryMappingIndex().FindMimeType(ext_narrow_str);
   if (mime_type) {
     *result = mime_type;
     return true;
@@ -738,23 +787,24 @@ static const StandardType kStandardTypes[] = {{"image/", kStandardImageTypes},
 //
 //  * If |prefix_match = true| then |mime_type| is treated as the prefix for a
 //    (case-insensitive) string. For instance "Text/" would match "text/plain".
+//
+// The MIME maps only hold lower-case types, so callers lower-case |mime_type|.
 void GetExtensionsFromHardCodedMappings(
-    base::span<const MimeInfo> mappings,
+    const MimeMappingIndex& index,
     const std::string& mime_type,
     bool prefix_match,
     std::unordered_set<base::FilePath::StringType>* extensions) {
-  for (const auto& mapping : mappings) {
-    base::StringPiece cur_mime_type(mapping.mime_type);
-
-    if (base::StartsWith(cur_mime_type, mime_type,
-                         base::CompareCase::INSENSITIVE_ASCII) &&
-        (prefix_match || (cur_mime_type.length() == mime_type.length()))) {
-      for (const base::StringPiece& this_extension : base::SplitStringPiece(
-               mapping.extensions, ",", base::TRIM_WHITESPACE,
-               base::SPLIT_WANT_ALL)) {
-        extensions->insert(StringToFilePathStringType(this_extension));
-      }
-    }
+  DCHECK_EQ(base::ToLowerASCII(mime_type), mime_type);
+  auto add_extensions =
+      [extensions](const std::vector<base::StringPiece>& mapping_extensions) {
+        for (base::StringPiece extension : mapping_extensions)
+          extensions->insert(StringToFilePathStringType(extension));
+      };
+  if (prefix_match) {
+    index.ForEachMimeTypeWithPrefix(mime_type, add_extensions);
+  } else if (const std::vector<base::StringPiece>* mapping_extensions =
+                 index.FindExtensions(mime_type)) {
+    add_extensions(*mapping_extensions);
   }
 }
 
@@ -769,11 +819,11 @@ void GetExtensionsHelper(
 
   // Also look up the extensions from hard-coded mappings in case that some
   // supported extensions are not registered in the system registry, like ogg.
-  GetExtensionsFromHardCodedMappings(kPrimaryMappings, leading_mime_type, true,
-                                     extensions);
-
-  GetExtensionsFromHardCodedMappings(kSecondaryMappings, leading_mime_type,
+  GetExtensionsFromHardCodedMappings(PrimaryMappingIndex(), leading_mime_type,
                                      true, extensions);
+
+  GetExtensionsFromHardCodedMappings(SecondaryMappingIndex(),
+                                     leading_mime_type, true, extensions);
 }
 
 // Note that the elements in the source set will be appended to the target
@@ -835,11 +885,11 @@ void GetExtensionsForMimeType(
 
     // Also look up the extensions from hard-coded mappings in case that some
     // supported extensions are not registered in the system registry, like ogg.
-    GetExtensionsFromHardCodedMappings(kPrimaryMappings, mime_type, false,
+    GetExtensionsFromHardCodedMappings(PrimaryMappingIndex(), mime_type, false,
                                        &unique_extensions);
 
-    GetExtensionsFromHardCodedMappings(kSecondaryMappings, mime_type, false,
-                                       &unique_extensions);
+    GetExtensionsFromHardCodedMappings(SecondaryMappingIndex(), mime_type,
+                                       false, &unique_extensions);
   }
 
   UnorderedSetToVector(&unique_extensions, extensions);
@@ -885,17 +935,17 @@ void AddMultipartValueForUpload(const std::string& value_name,
                                 const std::string& content_type,
                                 std::string* post_data) {
   DCHECK(post_data);
-  // First line is the boundary.
-  post_data->append("--" + mime_boundary + "\r\n");
-  // Next line is the Content-disposition.
-  post_data->append("Content-Disposition: form-data; name=\"" +
-                    value_name + "\"\r\n");
+  // First line is the boundary. Next line is the Content-disposition.
+  base::StrAppend(post_data,
+                  {"--", mime_boundary, "\r\n",
+                   "Content-Disposition: form-data; name=\"", value_name,
+                   "\"\r\n"});
   if (!content_type.empty()) {
     // If Content-type is specified, the next line is that.
-    post_data->append("Content-Type: " + content_type + "\r\n");
+    base::StrAppend(post_data, {"Content-Type: ", content_type, "\r\n"});
   }
   // Leave an empty line and append the value.
-  post_data->append("\r\n" + value + "\r\n");
+  base::StrAppend(post_data, {"\r\n", value, "\r\n"});
 }
 
 void AddMultipartValueForUploadWithFileName(const std::string& value_name,
@@ -905,23 +955,23 @@ void AddMultipartValueForUploadWithFileName(const std::string& value_name,
                                             const std::string& content_type,
                                             std::string* post_data) {
   DCHECK(post_data);
-  // First line is the boundary.
-  post_data->append("--" + mime_boundary + "\r\n");
-  // Next line is the Content-disposition.
-  post_data->append("Content-Disposition: form-data; name=\"" + value_name +
-                    "\"; filename=\"" + file_name + "\"\r\n");
+  // First line is the boundary. Next line is the Content-disposition.
+  base::StrAppend(post_data,
+                  {"--", mime_boundary, "\r\n",
+                   "Content-Disposition: form-data; name=\"", value_name,
+                   "\"; filename=\"", file_name, "\"\r\n"});
   if (!content_type.empty()) {
     // If Content-type is specified, the next line is that.
-    post_data->append("Content-Type: " + content_type + "\r\n");
+    base::StrAppend(post_data, {"Content-Type: ", content_type, "\r\n"});
   }
   // Leave an empty line and append the value.
-  post_data->append("\r\n" + value + "\r\n");
+  base::StrAppend(post_data, {"\r\n", value, "\r\n"});
 }
 
 void AddMultipartFinalDelimiterForUpload(const std::string& mime_boundary,
                                          std::string* post_data) {
   DCHECK(post_data);
-  post_data->append("--" + mime_boundary + "--\r\n");
+  base::StrAppend(post_data, {"--", mime_boundary, "--\r\n"});
 }
 
 }  // namespace net
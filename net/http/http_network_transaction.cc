@@ -12,6 +12,7 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/compiler_specific.h"
+#include "base/containers/fixed_flat_set.h"
 #include "base/feature_list.h"
 #include "base/format_macros.h"
 #include "base/metrics/field_trial.h"
@@ -19,6 +20,7 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/time/time.h"
 #include "base/values.h"
@@ -106,6 +108,30 @@ void SetProxyInfoInReponse(const ProxyInfo& proxy_info,
     response_info->proxy_server = ProxyServer();
 }
 
+// Lets the local New Tab Page read responses from these hosts. Only default
+// ports qualify, as with the "host[:port]" comparison this replaces.
+bool ShouldAddNewTabPageCorsHeaders(const GURL& url) {
+  static constexpr auto kHosts = base::MakeFixedFlatSet<base::StringPiece>(
+      {"consent.google.com", "d3ward.github.io", "news.google.com"});
+  return !url.has_port() && kHosts.contains(url.host_piece());
+}
+
+// Adds the headers of ShouldAddNewTabPageCorsHeaders() that the server did
+// not send. Done once per response, when its headers are received, so the
+// const getters stay plain accessors.
+void AddNewTabPageCorsHeaders(HttpResponseHeaders* headers) {
+  static constexpr std::pair<const char*, const char*> kHeaders[] = {
+      {"Access-Control-Allow-Origin", "chrome-search://local-ntp"},
+      {"Access-Control-Expose-Headers", "chrome-search://local-ntp"},
+      {"Access-Control-Allow-Credentials", "true"},
+      {"X-Kiwi-Processed", "Yes"},
+  };
+  for (const auto& header : kHeaders) {
+    if (!headers->HasHeader(header.first))
+      headers->AddHeader(header.first, header.second);
+  }
+}
+
 }  // namespace
 
 const int HttpNetworkTransaction::kDrainBodyBufferSize;
@@ -1181,6 +1207,9 @@ int HttpNetworkTransaction::DoReadHeadersComplete(int result) {
     return OK;
   }
 
+  if (ShouldAddNewTabPageCorsHeaders(request_->url))
+    AddNewTabPageCorsHeaders(response_.headers.get());
+
   NetLogResponseHeaders(net_log_,
                         NetLogEventType::HTTP_TRANSACTION_READ_RESPONSE_HEADERS,
                         response_.headers.get());
@@ -1705,28 +1734,6 @@ void HttpNetworkTransaction::CacheNetErrorDetailsAndResetStream() {
 }
 
 HttpResponseHeaders* HttpNetworkTransaction::GetResponseHeaders() const {
-  std::string header_value_;
-  std::string header_value_1;
-  std::string header_value_2;
-  std::string header_value_3;
-
-  if (request_ != NULL
-      && (GetHostAndOptionalPort(request_->url) == "news.google.com" || GetHostAndOptionalPort(request_->url) == "consent.google.com" || GetHostAndOptionalPort(request_->url) == "d3ward.github.io"))
-  {
-     if (response_.headers && !response_.headers->GetNormalizedHeader(
-             "Access-Control-Allow-Origin", &header_value_))
-       response_.headers->AddHeader("Access-Control-Allow-Origin", "chrome-search://local-ntp");
-     if (response_.headers && !response_.headers->GetNormalizedHeader(
-             "Access-Control-Expose-Headers", &header_value_1))
-       response_.headers->AddHeader("Access-Control-Expose-Headers", "chrome-search://local-ntp");
-     if (response_.headers && !response_.headers->GetNormalizedHeader(
-             "Access-Control-Allow-Credentials", &header_value_2))
-       response_.headers->AddHeader("Access-Control-Allow-Credentials", "true");
-     if (response_.headers && !response_.headers->GetNormalizedHeader(
-             "X-Kiwi-Processed", &header_value_3))
-       response_.headers->AddHeader("X-Kiwi-Processed", "Yes");
-  }
-
   return response_.headers.get();
 }
 
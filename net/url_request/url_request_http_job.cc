@@ -14,6 +14,7 @@
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
 #include "base/compiler_specific.h"
+#include "base/containers/flat_map.h"
 #include "base/file_version_info.h"
 #include "base/location.h"
 #include "base/macros.h"
@@ -21,9 +22,12 @@
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/no_destructor.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/rand_util.h"
 #include "base/single_thread_task_runner.h"
+#include "base/stl_util.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -186,6 +190,143 @@ bool IsTLS13OverTCP(const net::HttpResponseInfo& response_info) {
          net::SSL_CONNECTION_VERSION_TLS1_3;
 }
 
+// Per-site request header rewrites. A rule applies when the request host or
+// one of its dot-separated suffixes is |domain| (or, for kLabel rules, when one
+// of the host's labels is |domain|) and the path and query contain the given
+// substrings. The rules are indexed once, so a request costs one lookup per
+// host label however many rules there are; the header values are literals.
+enum class HostMatch {
+  kSuffix,
+  kLabel,
+};
+
+struct HeaderRewriteRule {
+  const char* domain;
+  HostMatch host_match;
+  const char* path_substring;
+  const char* query_substring;
+  // Only the first matching rule that overrides the User-Agent applies.
+  const char* user_agent;
+  const char* cookie;
+  const char* forwarded_for;
+  bool remove_referer;
+};
+
+constexpr HeaderRewriteRule kHeaderRewriteRules[] = {
+    {"addons.opera.com", HostMatch::kSuffix, nullptr, nullptr,
+     "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+     "Chrome/73.0.3683.86 Safari/537.36 OPR/60.0.3255.27 (Edition developer)",
+     nullptr, nullptr, false},
+    {"chrome.google.com", HostMatch::kSuffix, nullptr, nullptr,
+     "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+     "Chrome/93.0.4577.25 Safari/537.36",
+     nullptr, nullptr, false},
+    {"web.whatsapp.com", HostMatch::kSuffix, nullptr, nullptr,
+     "Mozilla/5.0 (X11; Linux) AppleWebKit/537.36 (KHTML, like Gecko) "
+     "Chrome/93.0.4577.25 Mobile Safari/537.36",
+     nullptr, nullptr, false},
+    {"messenger.com", HostMatch::kSuffix, nullptr, nullptr,
+     "Mozilla/5.0 (X11; Ubuntu; Linux x86_64; rv:57.0) Gecko/20100101 "
+     "Firefox/57.0",
+     nullptr, nullptr, false},
+    {"facebook.com", HostMatch::kSuffix, nullptr, nullptr,
+     "Mozilla/5.0 (Mobile; rv:48.0; A405DL) Gecko/48.0 Firefox/48.0 "
+     "KAIOS/2.5",
+     nullptr, nullptr, false},
+    {"news.google.com", HostMatch::kSuffix,
+     "CAAqJggKIiBDQkFTRWdvSUwyMHZNRFZxYUdjU0FtVnVHZ0pWVXlnQVAB", nullptr,
+     "Mozilla/5.0 (Linux; Android 9; ONEPLUS A6003) AppleWebKit/537.36 "
+     "(KHTML, like Gecko) Chrome/71.0.3578.99 Mobile Safari/537.36",
+     "CONSENT=YES+srp.gws-20210610-0-RC2.en+FX+320;", nullptr, false},
+    {"washingtonpost.com", HostMatch::kSuffix, nullptr, nullptr, nullptr,
+     nullptr, "1.1.1.1", false},
+    {"amazon", HostMatch::kLabel, nullptr, "kbdirect", nullptr, nullptr,
+     nullptr, true},
+};
+static_assert(base::size(kHeaderRewriteRules) <= 32,
+              "matches are collected in a 32-bit mask");
+
+class HeaderRewriteRuleIndex {
+ public:
+  static const HeaderRewriteRuleIndex& GetInstance() {
+    static const base::NoDestructor<HeaderRewriteRuleIndex> instance;
+    return *instance;
+  }
+
+  HeaderRewriteRuleIndex(const HeaderRewriteRuleIndex&) = delete;
+  HeaderRewriteRuleIndex& operator=(const HeaderRewriteRuleIndex&) = delete;
+
+  // Returns a mask of the rules of kHeaderRewriteRules whose host part
+  // matches |host|; bit i stands for rule i.
+  uint32_t MatchHost(base::StringPiece host) const {
+    uint32_t matches = 0;
+    while (!host.empty()) {
+      const size_t dot = host.find('.');
+      matches |= Lookup(suffixes_, host);
+      matches |= Lookup(labels_, host.substr(0, dot));
+      if (dot == base::StringPiece::npos)
+        break;
+      host.remove_prefix(dot + 1);
+    }
+    return matches;
+  }
+
+ private:
+  friend class base::NoDestructor<HeaderRewriteRuleIndex>;
+
+  using Index = base::flat_map<base::StringPiece, uint32_t>;
+
+  HeaderRewriteRuleIndex() {
+    for (size_t i = 0; i < base::size(kHeaderRewriteRules); ++i) {
+      const HeaderRewriteRule& rule = kHeaderRewriteRules[i];
+      Index& index =
+          rule.host_match == HostMatch::kSuffix ? suffixes_ : labels_;
+      index[rule.domain] |= 1u << i;
+    }
+  }
+  ~HeaderRewriteRuleIndex() = default;
+
+  static uint32_t Lookup(const Index& index, base::StringPiece key) {
+    auto it = index.find(key);
+    return it == index.end() ? 0 : it->second;
+  }
+
+  Index suffixes_;
+  Index labels_;
+};
+
+void ApplyHeaderRewriteRules(const GURL& url,
+                             net::HttpRequestHeaders* headers) {
+  uint32_t matches =
+      HeaderRewriteRuleIndex::GetInstance().MatchHost(url.host_piece());
+  bool user_agent_overridden = false;
+  for (size_t i = 0; matches; ++i, matches >>= 1) {
+    if (!(matches & 1))
+      continue;
+    const HeaderRewriteRule& rule = kHeaderRewriteRules[i];
+    if (rule.user_agent && user_agent_overridden)
+      continue;
+    if (rule.path_substring &&
+        url.path_piece().find(rule.path_substring) == base::StringPiece::npos) {
+      continue;
+    }
+    if (rule.query_substring && url.query_piece().find(rule.query_substring) ==
+                                    base::StringPiece::npos) {
+      continue;
+    }
+    if (rule.user_agent) {
+      headers->SetHeader(net::HttpRequestHeaders::kUserAgent, rule.user_agent);
+      user_agent_overridden = true;
+    }
+    if (rule.cookie)
+      headers->SetHeader(net::HttpRequestHeaders::kCookie, rule.cookie);
+    if (rule.forwarded_for)
+      headers->SetHeader("X-Forwarded-For", rule.forwarded_for);
+    if (rule.remove_referer)
+      headers->RemoveHeader(net::HttpRequestHeaders::kReferer);
+  }
+}
+
 }  // namespace
 
 namespace net {
@@ -312,39 +453,7 @@ void URLRequestHttpJob::Start() {
       http_user_agent_settings_ ?
           http_user_agent_settings_->GetUserAgent() : std::string());
 
-  if (request_info_.url.host().find("addons.opera.com") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/73.0.3683.86 Safari/537.36 OPR/60.0.3255.27 (Edition developer)");
-  }
-  else if (request_info_.url.host().find("chrome.google.com") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/93.0.4577.25 Safari/537.36");
-  }
-  else if (request_info_.url.host().find("web.whatsapp.com") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (X11; Linux) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/93.0.4577.25 Mobile Safari/537.36");
-  }
-  else if (request_info_.url.host().find("messenger.com") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (X11; Ubuntu; Linux x86_64; rv:57.0) Gecko/20100101 Firefox/57.0");
-  }
-  else if (request_info_.url.host().find("facebook.com") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (Mobile; rv:48.0; A405DL) Gecko/48.0 Firefox/48.0 KAIOS/2.5");
-  }
-  else if (request_info_.url.host().find("news.google.com") != std::string::npos && request_info_.url.path().find("CAAqJggKIiBDQkFTRWdvSUwyMHZNRFZxYUdjU0FtVnVHZ0pWVXlnQVAB") != std::string::npos)
-  {
-     request_info_.extra_headers.SetHeader(HttpRequestHeaders::kUserAgent, "Mozilla/5.0 (Linux; Android 9; ONEPLUS A6003) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/71.0.3578.99 Mobile Safari/537.36");
-     request_info_.extra_headers.SetHeader("Cookie", "CONSENT=YES+srp.gws-20210610-0-RC2.en+FX+320;");
-  }
-
-  if (request_info_.url.host().find("washingtonpost.com") != std::string::npos) {
-     request_info_.extra_headers.SetHeader("X-Forwarded-For", "1.1.1.1");
-  }
-
-  if (request_info_.url.host().find("amazon") != std::string::npos && request_info_.url.query().find("kbdirect") != std::string::npos) {
-     request_info_.extra_headers.RemoveHeader(HttpRequestHeaders::kReferer);
-  }
+  ApplyHeaderRewriteRules(request_info_.url, &request_info_.extra_headers);
 
   AddExtraHeaders();
   AddCookieHeaderAndStart();
@@ -0,0 +1,92 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_BLINK_RENDERER_CORE_CSS_COSMETIC_FILTER_H_
+#define THIRD_PARTY_BLINK_RENDERER_CORE_CSS_COSMETIC_FILTER_H_
+
+#include "base/no_destructor.h"
+#include "third_party/blink/public/platform/web_content_settings_client.h"
+#include "third_party/blink/renderer/core/dom/document.h"
+#include "third_party/blink/renderer/core/frame/local_frame.h"
+#include "third_party/blink/renderer/core/loader/multi_substring_matcher.h"
+#include "third_party/blink/renderer/platform/wtf/text/wtf_string.h"
+
+namespace blink {
+
+// Page-level decisions of the built-in cosmetic filter. The attribute rules
+// themselves are a user-origin style sheet that StyleEngine injects into
+// every page that is not exempt (see style_engine.cc); LayoutObject only
+// handles the few rules that a selector cannot express.
+
+enum CosmeticPageCategory : uint32_t {
+  kCosmeticPageExempt = 1 << 0,
+  // Exempt, except for the "mealbar:0" banner.
+  kCosmeticPageYoutube = 1 << 1,
+  kCosmeticPageDuckDuckGo = 1 << 2,
+};
+
+// Pages whose elements are never filtered, matched against the page host.
+constexpr const char* kCosmeticExemptHostSubstrings[] = {
+    "google",
+    "kiwisearchservices.com",
+    "kiwisearchservices.net",
+    "doubleclick",
+    "bing",
+    "qwant",
+    "startpage",
+    "yahoo",
+    ".amazon.",
+    "sueddeutsche.de",
+    "find.kiwi",
+    "ecosia.org",
+    "flashx",
+    ".ebay.",
+    "kiwibrowser.org",
+};
+
+// Returns the page categories of |document|. Main thread only: the page
+// categories only depend on the document URL, and consecutive callers nearly
+// always ask about the same document, so the last result is kept instead of
+// taking the host and scanning it on every call.
+inline uint32_t GetCosmeticPageCategories(const Document& document) {
+  DCHECK(IsMainThread());
+  static const MultiSubstringMatcher* const page_hosts = [] {
+    auto* matcher = new MultiSubstringMatcher();
+    for (const char* substring : kCosmeticExemptHostSubstrings)
+      matcher->AddPattern(substring, kCosmeticPageExempt);
+    matcher->AddPattern("youtube", kCosmeticPageYoutube);
+    matcher->AddPattern("duckduckgo", kCosmeticPageDuckDuckGo);
+    matcher->Build();
+    return matcher;
+  }();
+  static base::NoDestructor<String> cached_url;
+  static uint32_t cached_categories = 0;
+  const String& url = document.Url().GetString();
+  if (url.Impl() != cached_url->Impl() && url != *cached_url) {
+    *cached_url = url;
+    cached_categories = page_hosts->Match(document.Url().Host());
+  }
+  return cached_categories;
+}
+
+// Whether the user allowed ads on |document|, which turns the filter off.
+inline bool CosmeticFilterAllowsAds(const Document& document) {
+  LocalFrame* frame = document.GetFrame();
+  if (!frame)
+    return false;
+  WebContentSettingsClient* content_settings_client =
+      frame->GetContentSettingsClient();
+  return content_settings_client && content_settings_client->AllowAds(true);
+}
+
+// Injects the cosmetic filter sheet into, or removes it from, the user sheets
+// of |document| when the page categories or the AllowAds setting no longer
+// agree with it. Called on every user style update and at the start of every
+// lifecycle update, as neither a same-document navigation (pushState) nor an
+// AllowAds change restyles the page. Defined in style_engine.cc.
+void UpdateCosmeticFilterSheet(Document& document);
+
+}  // namespace blink
+
+#endif  // THIRD_PARTY_BLINK_RENDERER_CORE_CSS_COSMETIC_FILTER_H_
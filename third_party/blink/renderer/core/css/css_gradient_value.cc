@@ -30,7 +30,9 @@
 #include <tuple>
 #include <utility>
 
+#include "base/auto_reset.h"
 #include "base/cxx17_backports.h"
+#include "base/no_destructor.h"
 #include "third_party/blink/renderer/core/css/css_color.h"
 #include "third_party/blink/renderer/core/css/css_identifier_value.h"
 #include "third_party/blink/renderer/core/css/css_math_expression_node.h"
@@ -38,23 +40,25 @@
 #include "third_party/blink/renderer/core/css/css_numeric_literal_value.h"
 #include "third_party/blink/renderer/core/css/css_to_length_conversion_data.h"
 #include "third_party/blink/renderer/core/css/css_value_pair.h"
+#include "third_party/blink/renderer/core/css/document_dark_mode_state.h"
 #include "third_party/blink/renderer/core/css/properties/computed_style_utils.h"
 #include "third_party/blink/renderer/core/css_value_keywords.h"
 #include "third_party/blink/renderer/core/dom/node_computed_style.h"
 #include "third_party/blink/renderer/core/dom/text_link_colors.h"
 #include "third_party/blink/renderer/platform/geometry/int_size.h"
+#include "third_party/blink/renderer/platform/geometry/float_size_hash.h"
 #include "third_party/blink/renderer/platform/graphics/color_blend.h"
+#include "third_party/blink/renderer/platform/graphics/dark_mode_filter.h"
+#include "third_party/blink/renderer/platform/graphics/dark_mode_settings_builder.h"
 #include "third_party/blink/renderer/platform/graphics/gradient.h"
 #include "third_party/blink/renderer/platform/graphics/gradient_generated_image.h"
 #include "third_party/blink/renderer/platform/graphics/image.h"
 #include "third_party/blink/renderer/platform/graphics/skia/skia_utils.h"
 #include "third_party/blink/renderer/platform/heap/heap.h"
+#include "third_party/blink/renderer/platform/heap/persistent.h"
 #include "third_party/blink/renderer/platform/wtf/text/string_builder.h"
 #include "third_party/blink/renderer/platform/wtf/text/wtf_string.h"
 
-#include "third_party/blink/renderer/core/frame/settings.h"
-#include "third_party/blink/renderer/core/frame/local_frame.h"
-
 namespace blink {
 namespace cssvalue {
 
@@ -96,6 +100,58 @@ bool AppendPosition(StringBuilder& result,
   return true;
 }
 
+// Set while GetImage() builds a gradient for a page in forced dark mode, so
+// that the stop colors are darkened like backgrounds are.
+DarkModeFilter* g_stop_color_dark_mode_filter = nullptr;
+
+DarkModeFilter& GetGradientDarkModeFilter() {
+  // The dark mode settings are fixed for the lifetime of the renderer. The
+  // filter caches the inverted colors, which gradients mostly share.
+  static base::NoDestructor<DarkModeFilter> filter(
+      GetCurrentDarkModeSettings());
+  return *filter;
+}
+
+// The darkened images of cacheable gradients. CSSImageGeneratorValue's cache
+// is keyed by size only and holds the regular images, so the darkened ones
+// are kept here until the gradient is collected. A gradient of a class rule is
+// shared by elements of different sizes, so each keeps the images of the last
+// few sizes it was drawn at, replaced in turn.
+struct DarkModeGradientImages {
+  DISALLOW_NEW();
+
+ public:
+  static constexpr size_t kMaxSizes = 4;
+
+  Image* Get(const FloatSize& size) const {
+    for (size_t i = 0; i < kMaxSizes; ++i) {
+      if (images[i] && sizes[i] == size)
+        return images[i].get();
+    }
+    return nullptr;
+  }
+
+  void Put(const FloatSize& size, scoped_refptr<Image> image) {
+    sizes[next] = size;
+    images[next] = std::move(image);
+    next = (next + 1) % kMaxSizes;
+  }
+
+  FloatSize sizes[kMaxSizes];
+  scoped_refptr<Image> images[kMaxSizes];
+  size_t next = 0;
+};
+
+using DarkModeGradientImageCache =
+    HeapHashMap<WeakMember<const CSSGradientValue>, DarkModeGradientImages>;
+
+DarkModeGradientImageCache& GetDarkModeGradientImageCache() {
+  DCHECK(IsMainThread());
+  DEFINE_STATIC_LOCAL(Persistent<DarkModeGradientImageCache>, cache,
+                      (MakeGarbageCollected<DarkModeGradientImageCache>()));
+  return *cache;
+}
+
 }  // anonymous ns
 
 bool CSSGradientColorStop::IsCacheable() const {
@@ -124,17 +180,23 @@ scoped_refptr<Image> CSSGradientValue::GetImage(
   if (size.IsEmpty())
     return nullptr;
 
-  auto* settings = document.GetFrame()->GetSettings();
-  if (settings && settings->GetForceDarkModeEnabled()) {
-    return nullptr;
-  }
+  const bool force_dark =
+      GetDocumentDarkModeState(document).force_dark_mode_enabled;
 
   if (is_cacheable_) {
     if (!Clients().Contains(&client))
       return nullptr;
 
-    if (Image* result = CSSImageGeneratorValue::GetImage(&client, size))
+    if (force_dark) {
+      auto it = GetDarkModeGradientImageCache().find(this);
+      if (it != GetDarkModeGradientImageCache().end()) {
+        if (Image* result = it->value.Get(size))
+          return result;
+      }
+    } else if (Image* result =
+                   CSSImageGeneratorValue::GetImage(&client, size)) {
       return result;
+    }
   }
 
   // We need to create an image.
@@ -145,6 +207,9 @@ scoped_refptr<Image> CSSGradientValue::GetImage(
       &style, root_style, document.GetLayoutView(),
       /* nearest_container */ nullptr, style.EffectiveZoom());
 
+  base::AutoReset<DarkModeFilter*> stop_color_dark_mode_filter(
+      &g_stop_color_dark_mode_filter,
+      force_dark ? &GetGradientDarkModeFilter() : nullptr);
   scoped_refptr<Gradient> gradient;
   switch (GetClassType()) {
     case kLinearGradientClass:
@@ -165,8 +230,15 @@ scoped_refptr<Image> CSSGradientValue::GetImage(
 
   scoped_refptr<Image> new_image =
       GradientGeneratedImage::Create(gradient, size);
-  if (is_cacheable_)
-    PutImage(size, new_image);
+  if (is_cacheable_) {
+    if (force_dark) {
+      GetDarkModeGradientImageCache()
+          .insert(this, DarkModeGradientImages())
+          .stored_value->value.Put(size, new_image);
+    } else {
+      PutImage(size, new_image);
+    }
+  }
 
   return new_image;
 }
@@ -308,9 +380,13 @@ static void ReplaceColorHintsWithColorStops(
 static Color ResolveStopColor(const CSSValue& stop_color,
                               const Document& document,
                               const ComputedStyle& style) {
-  return document.GetTextLinkColors().ColorFromCSSValue(
+  const Color color = document.GetTextLinkColors().ColorFromCSSValue(
       stop_color, style.VisitedDependentColor(GetCSSPropertyColor()),
       style.UsedColorScheme());
+  if (!g_stop_color_dark_mode_filter)
+    return color;
+  return Color(g_stop_color_dark_mode_filter->InvertColorIfNeeded(
+      color.Rgb(), DarkModeFilter::ElementRole::kBackground));
 }
 
 void CSSGradientValue::AddDeprecatedStops(GradientDesc& desc,
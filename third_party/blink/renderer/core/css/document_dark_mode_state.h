@@ -0,0 +1,68 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_BLINK_RENDERER_CORE_CSS_DOCUMENT_DARK_MODE_STATE_H_
+#define THIRD_PARTY_BLINK_RENDERER_CORE_CSS_DOCUMENT_DARK_MODE_STATE_H_
+
+#include <stdint.h>
+
+#include "third_party/blink/public/mojom/css/preferred_color_scheme.mojom-blink.h"
+#include "third_party/blink/renderer/core/dom/document.h"
+#include "third_party/blink/renderer/core/frame/settings.h"
+#include "third_party/blink/renderer/platform/heap/persistent.h"
+#include "third_party/blink/renderer/platform/wtf/std_lib_extras.h"
+
+namespace blink {
+
+// The dark mode settings of a document's frame, read by style and paint hot
+// paths instead of going from the document to its frame, page and Settings
+// on every call. Main thread only.
+struct DocumentDarkModeState {
+  bool force_dark_mode_enabled = false;
+  mojom::blink::PreferredColorScheme preferred_color_scheme =
+      mojom::blink::PreferredColorScheme::kLight;
+};
+
+namespace document_dark_mode_state_internal {
+
+inline uint64_t& Generation() {
+  static uint64_t generation = 0;
+  return generation;
+}
+
+}  // namespace document_dark_mode_state_internal
+
+// Drops the snapshot. Called by StyleEngine::UpdateColorScheme(), which runs
+// whenever the color scheme settings of a page change.
+inline void InvalidateDocumentDarkModeState() {
+  DCHECK(IsMainThread());
+  ++document_dark_mode_state_internal::Generation();
+}
+
+// Returns the state of |document|. Consecutive callers nearly always ask
+// about the same document, so only the last one is kept.
+inline const DocumentDarkModeState& GetDocumentDarkModeState(
+    const Document& document) {
+  DCHECK(IsMainThread());
+  DEFINE_STATIC_LOCAL(WeakPersistent<const Document>, cached_document, ());
+  static uint64_t cached_generation = 0;
+  static DocumentDarkModeState cached_state;
+  const uint64_t generation = document_dark_mode_state_internal::Generation();
+  if (cached_document.Get() != &document || cached_generation != generation) {
+    cached_document = &document;
+    cached_generation = generation;
+    cached_state = DocumentDarkModeState();
+    if (const Settings* settings = document.GetSettings()) {
+      cached_state.force_dark_mode_enabled =
+          settings->GetForceDarkModeEnabled();
+      cached_state.preferred_color_scheme =
+          settings->GetPreferredColorScheme();
+    }
+  }
+  return cached_state;
+}
+
+}  // namespace blink
+
+#endif  // THIRD_PARTY_BLINK_RENDERER_CORE_CSS_DOCUMENT_DARK_MODE_STATE_H_
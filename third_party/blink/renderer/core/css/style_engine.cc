@@ -33,6 +33,7 @@
 #include "third_party/blink/public/platform/platform.h"
 #include "third_party/blink/public/platform/web_theme_engine.h"
 #include "third_party/blink/renderer/core/css/container_query_evaluator.h"
+#include "third_party/blink/renderer/core/css/cosmetic_filter.h"
 #include "third_party/blink/renderer/core/css/counter_style_map.h"
 #include "third_party/blink/renderer/core/css/css_default_style_sheets.h"
 #include "third_party/blink/renderer/core/css/css_font_family_value.h"
@@ -41,6 +42,7 @@
 #include "third_party/blink/renderer/core/css/css_style_sheet.h"
 #include "third_party/blink/renderer/core/css/css_uri_value.h"
 #include "third_party/blink/renderer/core/css/css_value_list.h"
+#include "third_party/blink/renderer/core/css/document_dark_mode_state.h"
 #include "third_party/blink/renderer/core/css/document_style_environment_variables.h"
 #include "third_party/blink/renderer/core/css/document_style_sheet_collector.h"
 #include "third_party/blink/renderer/core/css/font_face_cache.h"
@@ -48,6 +50,7 @@
 #include "third_party/blink/renderer/core/css/invalidation/invalidation_set.h"
 #include "third_party/blink/renderer/core/css/media_feature_overrides.h"
 #include "third_party/blink/renderer/core/css/media_values.h"
+#include "third_party/blink/renderer/core/css/parser/css_parser_context.h"
 #include "third_party/blink/renderer/core/css/property_registration.h"
 #include "third_party/blink/renderer/core/css/property_registry.h"
 #include "third_party/blink/renderer/core/css/resolver/scoped_style_resolver.h"
@@ -96,8 +99,11 @@
 #include "third_party/blink/renderer/platform/fonts/font_cache.h"
 #include "third_party/blink/renderer/platform/fonts/font_selector.h"
 #include "third_party/blink/renderer/platform/heap/heap.h"
+#include "third_party/blink/renderer/platform/heap/persistent.h"
 #include "third_party/blink/renderer/platform/instrumentation/histogram.h"
 #include "third_party/blink/renderer/platform/instrumentation/tracing/trace_event.h"
+#include "third_party/blink/renderer/platform/wtf/std_lib_extras.h"
+#include "third_party/blink/renderer/platform/wtf/text/string_builder.h"
 #include "third_party/blink/renderer/platform/wtf/vector.h"
 
 namespace blink {
@@ -111,8 +117,259 @@ CSSFontSelector* CreateCSSFontSelectorFor(Document& document) {
   return MakeGarbageCollected<CSSFontSelector>(document);
 }
 
+// Attribute rules of the built-in cosmetic filter. They are compiled once into
+// a user-origin sheet of display:none !important rules, so the regular RuleSet
+// matching and invalidation sets find the elements to hide incrementally.
+
+const char* const kBlockedClassSubstrings[] = {
+    "cc_banner", "cc-banner", "lg-cc", "app-recommand-layer",
+    "tea-mobilebanner", "truste_", "mobile-app-banner", "as-oil", "cnil",
+    "Cnil", "Partners", "addelivered", "billboard", "cams-widget",
+    "site-message", "contributions__epic", "outbrain", "flash-message",
+    "taboola", "evidon", "user-msg", "_Notice", "adspopup", "zergnet",
+    "results--ads", "js-atb-banner", "cbz-leaderboard-banner", "optanon-",
+    "privacyBarComponent", "SnackBar", "question_page_ad", "TopButton pulse",
+    "fbPageBanner", "DualPartInterstitial", "bst-panel-fixed",
+    "vidzi_backscreen2", "custom-zivert-banner", "tab-bar-fixed", "320X50",
+    "lefermeur", "surprise-container", "facebok", "bx-campaign-", "t-i-agree",
+    "OUTBRAIN", "sticky-art", "sticky-bar-bottom", "dy-modal-container",
+    "_3ySVUrHPphSj5g2JqDOctE", "_2eLBJDo4r_wxFuHkMXLiro", "social-share",
+    "smartbanner", "mfp-ready", "inlineOverlay", "inlinePopup",
+    "popup_tosEdition", "upsell-dialog-lightbox", "ytd-display-ad-",
+    "masthead-ad", "ytd-companion-slot-renderer",
+    "ytd-video-masthead-ad-v3-renderer",
+    "ytm-promoted-sparkles-text-search-renderer",
+    "ytm-promoted-sparkles-web-renderer", "ytp-ad-image-overlay",
+    "ytd-action-companion-ad-renderer", "ytp-ad-overlay-container",
+    "ytp-ad-progress", "ytd-carousel-ad-renderer",
+    "ytd-player-legacy-desktop-watch-ads-renderer",
+    "ytd-promoted-sparkles-text-search-renderer", "ytd-search-pyv-renderer",
+    "ytp-ad-message-container", "ytp-ad-player-overlay-flyout-cta",
+    "ytp-paid-content-overlay-text",
+};
+
+const char* const kBlockedIdSubstrings[] = {
+    "privacy-policy", "google_ads_iframe_", "ScriptRootC", "billboard",
+    "onesignal", "outbrain", "zergnet", "taboola", "content-ad-top-zone",
+    "ad-header-mobile", "ad320x50", "share-bar", "my_web_push_", "floatLayer1",
+    "floatLayer2",
+    "floatLayer3",  // in case it is used (not sure)
+    "video_ads_overdiv", "Composite",
+    "header-notices", "div-gpt-", "gpt_unit_", "signup_wall_wrapper",
+    "smartbanner", "toky",
+};
+
+const char* const kBlockedTypeSubstrings[] = {
+    "24smi", "a8", "a9", "accesstrade", "adagio", "adblade", "adbutler",
+    "adform", "adfox", "adgeneration", "adhese", "adincube", "adition", "adman",
+    "admanmedia", "admixer", "adocean", "adpicker", "adplugg", "adreactor",
+    "ads", "adsnative", "adspeed", "adspirit", "adstir", "adtech", "adthrive",
+    "aduptech", "adventive", "adverline", "adverticum", "advertserve",
+    "affiliateb", "amoad", "appnexus", "appvador", "atomx", "bidtellect",
+    "brainy", "bringhub", "broadstreetads", "caajainfeed", "capirs",
+    "caprofitx", "cedato", "chargeads", "colombia", "connatix", "contentad",
+    "criteo", "custom", "dable", "dianomi", "directadvert", "distroscale",
+    "dotandads", "doubleclick", "eadv", "eas", "engageya", "eplanning", "ezoic",
+    "f1e", "f1h", "felmat", "flite", "fluct", "fusion", "genieessp", "giraff",
+    "gmossp", "gumgum", "holder", "ibillboard", "imedia", "imobile", "imonomy",
+    "improvedigital", "industrybrains", "inmobi", "innity", "ix", "kargo",
+    "kiosked", "kixer", "kuadio", "ligatus", "lockerdome", "loka", "mads",
+    "mantis", "mediaimpact", "medianet", "mediavine", "medyanet", "meg",
+    "microad", "mixpo", "monetizer101", "mytarget", "mywidget", "nativo",
+    "navegg", "nend", "netletix", "nokta", "openadstream", "openx", "outbrain",
+    "pixels", "plista", "polymorphicads", "popin", "postquare", "pubexchange",
+    "pubguru", "pubmatic", "pubmine", "pulsepoint", "purch", "quoraad", "relap",
+    "revcontent", "revjet", "rubicon", "sekindo", "sharethrough", "sklik",
+    "slimcutmedia", "smartadserver", "smartclip", "smi2", "sogouad", "sortable",
+    "sovrn", "spotx", "sunmedia", "swoop", "taboola", "teads", "triplelift",
+    "trugaze", "uas", "valuecommerce", "videonow", "viralize", "vmfive",
+    "webediads", "weborama", "widespace", "wpmedia", "xlift", "yahoo",
+    "yahoojp", "yandex", "yengo", "yieldbot", "yieldmo", "yieldone", "yieldpro",
+    "zedo", "zergnet", "zucks",
+};
+
+const char* const kBlockedStyleSubstrings[] = {
+    "width:250", "width:468", "width: 250", "width:728px;height:90",
+    "width:728px; height:90", "width: 728px; height: 90",
+    "width:728 px; height:90", "width:728 px; height: 90",
+    "width:320px;height:50", "width:320px; height:50",
+    "width: 320px; height: 50", "width:320 px; height:50",
+    "width:320 px; height: 50", "width:300px;height:50",
+    "width:300px; height:50", "width: 300px; height: 50",
+    "width:300 px; height:50", "width:300 px; height: 50",
+    "width:300px;height:250", "width:300px; height:250",
+    "width: 300px; height: 250", "width:300 px; height:250",
+    "width:300 px; height: 250", "min-height:90px; max-height:90px",
+    "min-height:90px; max-height:250px", "min-height:250px; max-height:250px",
+    "min-height:300px; max-height:300px", "min-height:90px;max-height:90px",
+    "min-height:90px;max-height:250px", "min-height:250px;max-height:250px",
+    "min-height:300px;max-height:300px",
+    "transform-origin: left bottom 0px; height: 137px;",
+};
+
+const char* const kBlockedClasses[] = {
+    "BetterJsPopOverlay", "cbz-leaderboard-banner", "playerAdCtn",
+    "dgpr-drop-down", "post-footer-meta", "xenOverlay", "EUCookieNotice",
+    "FloatingOIA-container", "adContainer", "sharingfooter", "mobileHeaderPr",
+    "underPlayerPr", "video_ad", "sda-container", "md-banner-placement",
+    "smart-app-banner", "outeradcontainer", "mobile-header-space", "remove-ads",
+    "socialfooter",
+    "sticky-buttons  ",  // This is really like this
+    "add__wrp", "anchor_ad_wrapper",
+    "CookieBanner", "banner-container", "ads",
+};
+
+const char* const kBlockedIds[] = {
+    "afap-above-nav", "b_notificationContainer", "bnp_ttc_div",
+    "AdWidgetContainer", "exposeMask", "bvMSABanner", "notify-container",
+    "mobileFooterPr", "gh-appBanner", "sliding-popup", "smart-banner",
+    "sharingfooter", "privacy-consent", "footer_tc_privacy", "ad-footer",
+    "app-upsell", "dcMaavaronDiv", "x-home-messages", "x-messages-btn",
+    "x-messages", "bannerContainer", "content-supp", "content-supp-player",
+    "adbtm", "notice_banner", "megabanner", "surprise-full", "surprise-sticky",
+    "wp_social_popup_and_get_traffic", "stream-link", "openapp",
+    "relatedcontent", "app-bumper-main", "sm_follow_us", "topSocialPanel",
+    "markup", "sofascoreLiveStream", "player-preview-container",
+    "___ndtvpushdiv", "CatFish", "social-share", "js-gcm-notif", "pub-banner",
+    "upsell-banner", "button3", "html1", "html3",
+};
+
+// The document element, <body>, elements whose inline style moves them to
+// top: -5000px and left: -5000px (usually an ad blocker probe) and the
+// "adbdetect" bait are left alone, whatever rule they match. Both offsets must
+// be present, with or without a space after the colon.
+constexpr char kCosmeticFilterExemptions[] =
+    ":not(html):not(body):not([id=\"adbdetect\"])"
+    ":not([style*=\"top:-5000px\"][style*=\"left:-5000px\"],"
+    "[style*=\"top:-5000px\"][style*=\"left: -5000px\"],"
+    "[style*=\"top: -5000px\"][style*=\"left:-5000px\"],"
+    "[style*=\"top: -5000px\"][style*=\"left: -5000px\"])";
+
+// Builds the selector list of the cosmetic filter sheet. Each selector of the
+// list becomes its own RuleData, so exact id and class rules are bucketed
+// under that id or class and only substring rules are tried on every element.
+String CosmeticFilterSheetText() {
+  StringBuilder builder;
+  auto add_selector = [&builder](const StringView& prefix,
+                                 const char* attribute, const char* match,
+                                 const char* value, const char* extra) {
+    if (!builder.IsEmpty())
+      builder.Append(",\n");
+    builder.Append(prefix);
+    builder.Append('[');
+    builder.Append(attribute);
+    builder.Append(match);
+    builder.Append("=\"");
+    builder.Append(value);
+    builder.Append("\"]");
+    builder.Append(extra);
+    builder.Append(kCosmeticFilterExemptions);
+  };
+  auto add_substring = [&add_selector](const char* attribute,
+                                       const char* value) {
+    add_selector("", attribute, "*", value, "");
+  };
+  // "#x[id=x]" and ".x[class=x]": bucketed, but still compared as a whole and
+  // case-sensitively, also in quirks mode.
+  auto add_exact = [&add_selector](char prefix, const char* attribute,
+                                   const char* value) {
+    StringBuilder bucket;
+    bucket.Append(prefix);
+    bucket.Append(String(value).StripWhiteSpace());
+    add_selector(bucket.ToString(), attribute, "", value, "");
+  };
+
+  for (const char* value : kBlockedIds)
+    add_exact('#', "id", value);
+  for (const char* value : kBlockedClasses)
+    add_exact('.', "class", value);
+  for (const char* value : kBlockedIdSubstrings)
+    add_substring("id", value);
+  for (const char* value : kBlockedClassSubstrings)
+    add_substring("class", value);
+  for (const char* value : kBlockedTypeSubstrings)
+    add_substring("type", value);
+  for (const char* value : kBlockedStyleSubstrings)
+    add_substring("style", value);
+
+  add_selector("ins", "class", "*", "adsbygoogle", "");
+  add_selector("", "class", "*", "notification-bar",
+               ":not([class*=\"top-notification-bar\"])");
+  add_selector("", "class", "*", "ad_",
+               ":not([class*=\"text-ad_links\"]):not([class*=\"head\"])"
+               ":not([class*=\"pre-ad_container\"]):not([class*=\"read_\"])"
+               ":not([class*=\"pad_\"]):not([class*=\"oad_\"])"
+               ":not([class*=\"ead_\"])");
+  add_selector("", "id", "*", "cookie", ":not([id*=\"cookie-banner\"])");
+  add_selector("", "style", "*", "width: 468", ":not([id=\"banner_ad\"])");
+
+  builder.Append(" { display: none !important; }");
+  return builder.ToString();
+}
+
+StyleSheetContents* ParseCosmeticFilterSheet() {
+  auto* contents = MakeGarbageCollected<StyleSheetContents>(
+      MakeGarbageCollected<CSSParserContext>(
+          kHTMLStandardMode, SecureContextMode::kInsecureContext));
+  contents->ParseString(CosmeticFilterSheetText());
+  return contents;
+}
+
+// The parsed sheet and its RuleSet are shared by every document of the
+// process; each document only wraps it in its own CSSStyleSheet.
+StyleSheetContents* CosmeticFilterSheet() {
+  DCHECK(IsMainThread());
+  DEFINE_STATIC_LOCAL(Persistent<StyleSheetContents>, sheet,
+                      (ParseCosmeticFilterSheet()));
+  return sheet;
+}
+
+const StyleSheetKey& CosmeticFilterSheetKey() {
+  DEFINE_STATIC_LOCAL(const StyleSheetKey, key, ("kiwi-cosmetic-filter"));
+  return key;
+}
+
+bool ShouldApplyCosmeticFilter(const Document& document) {
+  // YouTube is only filtered for "mealbar:0", which LayoutObject hides on
+  // every page.
+  if (GetCosmeticPageCategories(document) &
+      (kCosmeticPageExempt | kCosmeticPageYoutube)) {
+    return false;
+  }
+  return !CosmeticFilterAllowsAds(document);
+}
+
+// Documents that have the cosmetic filter sheet among their injected user
+// sheets.
+HeapHashSet<WeakMember<Document>>& CosmeticFilteredDocuments() {
+  using DocumentSet = HeapHashSet<WeakMember<Document>>;
+  DEFINE_STATIC_LOCAL(Persistent<DocumentSet>, documents,
+                      (MakeGarbageCollected<DocumentSet>()));
+  return *documents;
+}
+
 }  // namespace
 
+void UpdateCosmeticFilterSheet(Document& document) {
+  if (!document.GetFrame())
+    return;
+  HeapHashSet<WeakMember<Document>>& filtered_documents =
+      CosmeticFilteredDocuments();
+  const bool is_applied = filtered_documents.Contains(&document);
+  if (ShouldApplyCosmeticFilter(document) == is_applied)
+    return;
+  if (is_applied) {
+    filtered_documents.erase(&document);
+    document.GetStyleEngine().RemoveInjectedSheet(CosmeticFilterSheetKey(),
+                                                  WebDocument::kUserOrigin);
+    return;
+  }
+  filtered_documents.insert(&document);
+  document.GetStyleEngine().InjectSheet(CosmeticFilterSheetKey(),
+                                        CosmeticFilterSheet(),
+                                        WebDocument::kUserOrigin);
+}
+
 StyleEngine::StyleEngine(Document& document)
     : document_(&document),
       document_style_sheet_collection_(
@@ -125,6 +382,8 @@ StyleEngine::StyleEngine(Document& document)
     font_selector_->RegisterForInvalidationCallbacks(this);
     if (const auto* owner = document.GetFrame()->Owner())
       owner_color_scheme_ = owner->GetColorScheme();
+    // Lets the first style update decide on the cosmetic filter sheet.
+    user_style_dirty_ = true;
   }
   if (document.IsInMainFrame())
     viewport_resolver_ = MakeGarbageCollected<ViewportStyleResolver>(document);
@@ -473,6 +732,8 @@ void StyleEngine::UpdateActiveStyleSheetsInShadow(
 void StyleEngine::UpdateActiveUserStyleSheets() {
   DCHECK(user_style_dirty_);
 
+  UpdateCosmeticFilterSheet(GetDocument());
+
   ActiveStyleSheetVector new_active_sheets;
   for (auto& sheet : injected_user_style_sheets_) {
     if (RuleSet* rule_set = RuleSetForSheet(*sheet.second))
@@ -2303,19 +2564,24 @@ void StyleEngine::UpdateColorScheme() {
   if (!settings || !web_theme_engine)
     return;
 
+  // The settings may have changed.
+  InvalidateDocumentDarkModeState();
+  const DocumentDarkModeState& dark_mode_state =
+      GetDocumentDarkModeState(GetDocument());
+
   ForcedColors old_forced_colors = forced_colors_;
   forced_colors_ = web_theme_engine->GetForcedColors();
 
   mojom::blink::PreferredColorScheme old_preferred_color_scheme =
       preferred_color_scheme_;
-  preferred_color_scheme_ = settings->GetPreferredColorScheme();
+  preferred_color_scheme_ = dark_mode_state.preferred_color_scheme;
   if (const auto* overrides =
           GetDocument().GetPage()->GetMediaFeatureOverrides()) {
     MediaQueryExpValue value = overrides->GetOverride("prefers-color-scheme");
     if (value.IsValid())
       preferred_color_scheme_ = CSSValueIDToPreferredColorScheme(value.id);
   }
-  if (!SupportsDarkColorScheme() && settings->GetForceDarkModeEnabled()) {
+  if (!SupportsDarkColorScheme() && dark_mode_state.force_dark_mode_enabled) {
     // Make sure we don't match (prefers-color-scheme: dark) when forced
     // darkening is enabled.
     preferred_color_scheme_ = mojom::blink::PreferredColorScheme::kDark;
@@ -2332,8 +2598,9 @@ void StyleEngine::UpdateColorScheme() {
 }
 
 void StyleEngine::UpdateColorSchemeMetrics() {
-  auto* settings = GetDocument().GetSettings();
-  if (settings->GetForceDarkModeEnabled())
+  const DocumentDarkModeState& dark_mode_state =
+      GetDocumentDarkModeState(GetDocument());
+  if (dark_mode_state.force_dark_mode_enabled)
     UseCounter::Count(GetDocument(), WebFeature::kForcedDarkMode);
 
   // True if the preferred color scheme will match dark.
@@ -2343,7 +2610,7 @@ void StyleEngine::UpdateColorSchemeMetrics() {
   // This is equal to kPreferredColorSchemeDark in most cases, but can differ
   // with forced dark mode. With the system in dark mode and forced dark mode
   // enabled, the preferred color scheme can be light while the setting is dark.
-  if (settings->GetPreferredColorScheme() ==
+  if (dark_mode_state.preferred_color_scheme ==
       mojom::blink::PreferredColorScheme::kDark) {
     UseCounter::Count(GetDocument(),
                       WebFeature::kPreferredColorSchemeDarkSetting);
@@ -2401,8 +2668,8 @@ void StyleEngine::UpdateColorSchemeBackground(bool color_scheme_changed) {
     // https://drafts.csswg.org/css-color-adjust/#color-scheme-effect
     mojom::blink::ColorScheme root_color_scheme =
         mojom::blink::ColorScheme::kLight;
-    auto* settings = GetDocument().GetSettings();
-    bool force_dark_enabled = settings && settings->GetForceDarkModeEnabled();
+    bool force_dark_enabled =
+        GetDocumentDarkModeState(GetDocument()).force_dark_mode_enabled;
     if (auto* root_element = GetDocument().documentElement()) {
       if (const ComputedStyle* style = root_element->GetComputedStyle())
         root_color_scheme = style->UsedColorSchemeForInitialColors();
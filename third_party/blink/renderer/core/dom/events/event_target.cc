@@ -31,15 +31,19 @@
 
 #include "third_party/blink/renderer/core/dom/events/event_target.h"
 
+#include <array>
 #include <memory>
 
+#include "base/feature_list.h"
 #include "base/format_macros.h"
+#include "base/no_destructor.h"
 #include "third_party/blink/public/web/web_settings.h"
 #include "third_party/blink/renderer/bindings/core/v8/js_based_event_listener.h"
 #include "third_party/blink/renderer/bindings/core/v8/js_event_listener.h"
 #include "third_party/blink/renderer/bindings/core/v8/source_location.h"
 #include "third_party/blink/renderer/bindings/core/v8/v8_union_addeventlisteneroptions_boolean.h"
 #include "third_party/blink/renderer/bindings/core/v8/v8_union_boolean_eventlisteneroptions.h"
+#include "third_party/blink/renderer/core/css/cosmetic_filter.h"
 #include "third_party/blink/renderer/core/dom/abort_signal.h"
 #include "third_party/blink/renderer/core/dom/events/add_event_listener_options_resolved.h"
 #include "third_party/blink/renderer/core/dom/events/event.h"
@@ -54,12 +58,14 @@
 #include "third_party/blink/renderer/core/frame/settings.h"
 #include "third_party/blink/renderer/core/frame/web_feature.h"
 #include "third_party/blink/renderer/core/inspector/console_message.h"
+#include "third_party/blink/renderer/core/loader/built_in_block_list.h"
 #include "third_party/blink/renderer/core/pointer_type_names.h"
 #include "third_party/blink/renderer/core/probe/core_probes.h"
 #include "third_party/blink/renderer/platform/bindings/exception_state.h"
 #include "third_party/blink/renderer/platform/bindings/v8_dom_activity_logger.h"
 #include "third_party/blink/renderer/platform/instrumentation/histogram.h"
 #include "third_party/blink/renderer/platform/instrumentation/use_counter.h"
+#include "third_party/blink/renderer/platform/weborigin/kurl.h"
 #include "third_party/blink/renderer/platform/wtf/assertions.h"
 #include "third_party/blink/renderer/platform/wtf/functional.h"
 #include "third_party/blink/renderer/platform/wtf/std_lib_extras.h"
@@ -104,11 +110,112 @@ bool IsScrollBlockingEvent(const AtomicString& event_type) {
          IsWheelScrollBlockingEvent(event_type);
 }
 
+// Makes the scroll-blocking listeners that scripts from block-listed hosts
+// (ad SDKs, chat widgets, ...) add to their own elements passive, unless they
+// ask for non-passive listeners explicitly.
+const base::Feature kPassiveListenersForBlockListedScripts{
+    "PassiveListenersForBlockListedScripts", base::FEATURE_ENABLED_BY_DEFAULT};
+
+// Whether |listener| is a function defined by a script that the fetch
+// blocker's host rules put in an ad, tracker or cookie consent category, or
+// whose path matches its ad path rules. Hosts the fetch blocker never filters
+// are left alone, and so are the pages it does not filter (allowlisted pages,
+// or the user allowed ads): there the scripts run on purpose. Listeners
+// defined by the page itself (inline scripts and handler attributes) carry the
+// page URL rather than a script URL of their own and are never matched.
+bool IsDefinedByBlockListedScript(EventTarget& target,
+                                  LocalDOMWindow& window,
+                                  EventListener* listener) {
+  auto* js_listener = DynamicTo<JSBasedEventListener>(listener);
+  if (!js_listener)
+    return false;
+  // The location of the function, not of the calling script, so that no
+  // stack trace is captured.
+  std::unique_ptr<SourceLocation> location =
+      js_listener->GetSourceLocation(target);
+  if (!location)
+    return false;
+  const KURL script_url(location->Url());
+  if (!script_url.IsValid() || script_url == window.Url())
+    return false;
+  const BuiltInBlockList& block_list = GetBuiltInBlockList();
+  const uint32_t host_categories = block_list.hosts.Match(script_url.Host());
+  if (host_categories & (kHostAllowed | kHostSearchAllowlisted))
+    return false;
+  if (!(host_categories & (kHostAlwaysBlocked | kHostAd | kHostTracker |
+                           kHostCookieConsent)) &&
+      !block_list.paths.MatchesAny(script_url.GetPath(), kPathAd)) {
+    return false;
+  }
+  return !(block_list.hosts.Match(window.Url().Host()) &
+           kHostPageAllowlisted) &&
+         !CosmeticFilterAllowsAds(*window.document());
+}
+
 bool IsInstrumentedForAsyncStack(const AtomicString& event_type) {
   return event_type == event_type_names::kLoad ||
          event_type == event_type_names::kError;
 }
 
+// What listener registration needs to know about an event type.
+enum EventTypeFlags : uint16_t {
+  kTouchScrollBlockingEvent = 1 << 0,
+  kWheelScrollBlockingEvent = 1 << 1,
+  // touchstart, touchmove, touchend and touchcancel.
+  kTouchEvent = 1 << 2,
+  // Counted by AddedEventListener().
+  kUseCountedOnAdd = 1 << 3,
+  kDOMMutationEvent = 1 << 4,
+  kInstrumentedForAsyncStack = 1 << 5,
+};
+
+uint16_t ComputeEventTypeFlags(const AtomicString& event_type) {
+  uint16_t flags = 0;
+  if (IsTouchScrollBlockingEvent(event_type))
+    flags |= kTouchScrollBlockingEvent;
+  if (IsWheelScrollBlockingEvent(event_type))
+    flags |= kWheelScrollBlockingEvent;
+  if (event_type == event_type_names::kTouchcancel ||
+      event_type == event_type_names::kTouchend ||
+      event_type == event_type_names::kTouchmove ||
+      event_type == event_type_names::kTouchstart) {
+    flags |= kTouchEvent;
+  }
+  if (event_type == event_type_names::kAuxclick ||
+      event_type == event_type_names::kAppinstalled ||
+      event_util::IsPointerEventType(event_type) ||
+      event_type == event_type_names::kSlotchange ||
+      event_type == event_type_names::kBeforematch) {
+    flags |= kUseCountedOnAdd;
+  }
+  if (event_util::IsDOMMutationEventType(event_type))
+    flags |= kDOMMutationEvent;
+  if (IsInstrumentedForAsyncStack(event_type))
+    flags |= kInstrumentedForAsyncStack;
+  return flags;
+}
+
+// Returns the flags of |event_type|. Registration goes through these flags
+// instead of comparing the type with each of the special ones, and pages add
+// listeners for a few types many times over, so on the main thread the flags
+// are kept in a small table indexed by the type's hash.
+uint16_t GetEventTypeFlags(const AtomicString& event_type) {
+  // AtomicStrings belong to the thread that made them.
+  if (!IsMainThread() || event_type.IsNull())
+    return ComputeEventTypeFlags(event_type);
+  struct Entry {
+    AtomicString event_type;
+    uint16_t flags = 0;
+  };
+  static base::NoDestructor<std::array<Entry, 64>> entries;
+  Entry& entry = (*entries)[event_type.Hash() % entries->size()];
+  if (entry.event_type != event_type) {
+    entry.event_type = event_type;
+    entry.flags = ComputeEventTypeFlags(event_type);
+  }
+  return entry.flags;
+}
+
 base::TimeDelta BlockedEventsWarningThreshold(ExecutionContext* context,
                                               const Event& event) {
   if (!event.cancelable())
@@ -290,7 +397,9 @@ void EventTarget::SetDefaultAddEventListenerOptions(
     AddEventListenerOptionsResolved* options) {
   options->SetPassiveSpecified(options->hasPassive());
 
-  if (!IsScrollBlockingEvent(event_type)) {
+  const uint16_t event_type_flags = GetEventTypeFlags(event_type);
+  if (!(event_type_flags &
+        (kTouchScrollBlockingEvent | kWheelScrollBlockingEvent))) {
     if (!options->hasPassive())
       options->setPassive(false);
     return;
@@ -306,7 +415,7 @@ void EventTarget::SetDefaultAddEventListenerOptions(
     }
   }
 
-  if (IsTouchScrollBlockingEvent(event_type)) {
+  if (event_type_flags & kTouchScrollBlockingEvent) {
     if (!options->hasPassive() && IsTopLevelNode()) {
       options->setPassive(true);
       options->SetPassiveForcedForDocumentTarget(true);
@@ -314,7 +423,7 @@ void EventTarget::SetDefaultAddEventListenerOptions(
     }
   }
 
-  if (IsWheelScrollBlockingEvent(event_type) && IsTopLevelNode()) {
+  if ((event_type_flags & kWheelScrollBlockingEvent) && IsTopLevelNode()) {
     if (options->hasPassive()) {
       if (executing_window) {
         UseCounter::Count(
@@ -371,6 +480,13 @@ void EventTarget::SetDefaultAddEventListenerOptions(
     }
   }
 
+  if (!options->hasPassive() && executing_window &&
+      base::FeatureList::IsEnabled(kPassiveListenersForBlockListedScripts) &&
+      IsDefinedByBlockListedScript(*this, *executing_window, event_listener)) {
+    options->setPassive(true);
+    return;
+  }
+
   if (!options->hasPassive())
     options->setPassive(false);
 
@@ -454,10 +570,8 @@ bool EventTarget::AddEventListenerInternal(
   if (options->hasSignal() && options->signal()->aborted())
     return false;
 
-  if (event_type == event_type_names::kTouchcancel ||
-      event_type == event_type_names::kTouchend ||
-      event_type == event_type_names::kTouchmove ||
-      event_type == event_type_names::kTouchstart) {
+  const uint16_t event_type_flags = GetEventTypeFlags(event_type);
+  if (event_type_flags & kTouchEvent) {
     if (const LocalDOMWindow* executing_window = ExecutingWindow()) {
       if (const Document* document = executing_window->document()) {
         document->CountUse(options->passive()
@@ -502,8 +616,8 @@ bool EventTarget::AddEventListenerInternal(
     }
 
     AddedEventListener(event_type, registered_listener);
-    if (IsA<JSBasedEventListener>(listener) &&
-        IsInstrumentedForAsyncStack(event_type)) {
+    if ((event_type_flags & kInstrumentedForAsyncStack) &&
+        IsA<JSBasedEventListener>(listener)) {
       probe::AsyncTaskScheduled(GetExecutionContext(), event_type,
                                 listener->async_task_id());
     }
@@ -514,7 +628,13 @@ bool EventTarget::AddEventListenerInternal(
 void EventTarget::AddedEventListener(
     const AtomicString& event_type,
     RegisteredEventListener& registered_listener) {
-  if (const LocalDOMWindow* executing_window = ExecutingWindow()) {
+  const uint16_t event_type_flags = GetEventTypeFlags(event_type);
+  if (!(event_type_flags & (kUseCountedOnAdd | kDOMMutationEvent)))
+    return;
+
+  const LocalDOMWindow* executing_window =
+      (event_type_flags & kUseCountedOnAdd) ? ExecutingWindow() : nullptr;
+  if (executing_window) {
     if (Document* document = executing_window->document()) {
       if (event_type == event_type_names::kAuxclick) {
         UseCounter::Count(*document, WebFeature::kAuxclickAddListenerCount);
@@ -530,7 +650,7 @@ void EventTarget::AddedEventListener(
     }
   }
 
-  if (event_util::IsDOMMutationEventType(event_type)) {
+  if (event_type_flags & kDOMMutationEvent) {
     if (ExecutionContext* context = GetExecutionContext()) {
       String message_text = String::Format(
           "Added synchronous DOM mutation listener to a '%s' event. "
@@ -35,6 +35,7 @@
 #include "base/memory/ptr_util.h"
 #include "base/metrics/field_trial_params.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "base/timer/lap_timer.h"
 #include "cc/animation/animation_host.h"
 #include "cc/document_transition/document_transition_request.h"
@@ -50,6 +51,8 @@
 #include "third_party/blink/renderer/bindings/core/v8/v8_scroll_into_view_options.h"
 #include "third_party/blink/renderer/core/accessibility/ax_object_cache.h"
 #include "third_party/blink/renderer/core/animation/document_animations.h"
+#include "third_party/blink/renderer/core/css/cosmetic_filter.h"
+#include "third_party/blink/renderer/core/css/document_dark_mode_state.h"
 #include "third_party/blink/renderer/core/css/font_face_set_document.h"
 #include "third_party/blink/renderer/core/css/style_change_reason.h"
 #include "third_party/blink/renderer/core/display_lock/display_lock_utilities.h"
@@ -216,6 +219,147 @@ void LogCursorSizeCounter(LocalFrame* frame, const ui::Cursor& cursor) {
 // has updated the url display.
 constexpr int kCommitDelayDefaultInMs = 500;  // 30 frames @ 60hz
 
+// Keeps the phase timings of the main frame's last lifecycle updates, to see
+// where time goes on user devices without tracing. A summary is logged each
+// time the buffer has been filled again.
+const base::Feature kLifecyclePhaseProfiler{"LifecyclePhaseProfiler",
+                                            base::FEATURE_DISABLED_BY_DEFAULT};
+
+class LifecyclePhaseProfiler {
+ public:
+  enum Phase {
+    kStyleAndLayout,
+    kAccessibility,
+    kCompositingInputs,
+    kPrePaint,
+    kCompositingAssignments,
+    kPaint,
+    kPhaseCount,
+  };
+
+  // Features that were active in a frame, which may explain its cost.
+  enum FeatureFlags : uint8_t {
+    kForceDarkMode = 1 << 0,
+    kTextAutosizing = 1 << 1,
+    kCosmeticFiltering = 1 << 2,
+  };
+
+  // Returns null unless the profiler is enabled. Main thread only.
+  static LifecyclePhaseProfiler* Get() {
+    DCHECK(IsMainThread());
+    static LifecyclePhaseProfiler* const profiler =
+        base::FeatureList::IsEnabled(kLifecyclePhaseProfiler)
+            ? new LifecyclePhaseProfiler()
+            : nullptr;
+    return profiler;
+  }
+
+  void BeginFrame(bool full_layout, wtf_size_t relayout_roots, uint8_t flags) {
+    current_ = Sample();
+    current_.full_layout = full_layout;
+    current_.relayout_roots = relayout_roots;
+    current_.flags = flags;
+    in_frame_ = true;
+  }
+
+  void AddPhaseTime(Phase phase, base::TimeDelta time) {
+    if (in_frame_)
+      current_.phase_times[phase] += time;
+  }
+
+  void EndFrame() {
+    DCHECK(in_frame_);
+    in_frame_ = false;
+    samples_[next_sample_] = current_;
+    next_sample_ = (next_sample_ + 1) % kSampleCount;
+    if (!next_sample_)
+      LOG(INFO) << Summary();
+  }
+
+ private:
+  static constexpr wtf_size_t kSampleCount = 256;
+
+  struct Sample {
+    base::TimeDelta phase_times[kPhaseCount];
+    bool full_layout = false;
+    wtf_size_t relayout_roots = 0;
+    uint8_t flags = 0;
+  };
+
+  std::string Summary() const {
+    static constexpr const char* kPhaseNames[kPhaseCount] = {
+        "style_and_layout",
+        "accessibility",
+        "compositing_inputs",
+        "pre_paint",
+        "compositing_assignments",
+        "paint",
+    };
+    std::string summary = base::StringPrintf(
+        "Lifecycle phases over the last %u frames:", kSampleCount);
+    for (int phase = 0; phase < kPhaseCount; ++phase) {
+      base::TimeDelta total;
+      base::TimeDelta max;
+      for (const Sample& sample : samples_) {
+        total += sample.phase_times[phase];
+        max = std::max(max, sample.phase_times[phase]);
+      }
+      base::StringAppendF(&summary, " %s mean %.2fms max %.2fms;",
+                          kPhaseNames[phase],
+                          (total / kSampleCount).InMillisecondsF(),
+                          max.InMillisecondsF());
+    }
+    int full_layouts = 0;
+    wtf_size_t relayout_roots = 0;
+    int dark_mode = 0;
+    int autosizing = 0;
+    int cosmetic_filtering = 0;
+    for (const Sample& sample : samples_) {
+      full_layouts += sample.full_layout;
+      relayout_roots += sample.relayout_roots;
+      dark_mode += !!(sample.flags & kForceDarkMode);
+      autosizing += !!(sample.flags & kTextAutosizing);
+      cosmetic_filtering += !!(sample.flags & kCosmeticFiltering);
+    }
+    base::StringAppendF(
+        &summary,
+        " %d full layouts, %u relayout roots; frames with forced dark mode "
+        "%d, text autosizing %d, cosmetic filtering %d",
+        full_layouts, relayout_roots, dark_mode, autosizing,
+        cosmetic_filtering);
+    return summary;
+  }
+
+  Sample samples_[kSampleCount];
+  wtf_size_t next_sample_ = 0;
+  Sample current_;
+  bool in_frame_ = false;
+};
+
+// Adds the time of its scope to a phase of the frame being profiled, if any.
+class ScopedLifecyclePhaseTimer {
+  STACK_ALLOCATED();
+
+ public:
+  explicit ScopedLifecyclePhaseTimer(LifecyclePhaseProfiler::Phase phase)
+      : profiler_(LifecyclePhaseProfiler::Get()), phase_(phase) {
+    if (profiler_)
+      start_ = base::TimeTicks::Now();
+  }
+  ScopedLifecyclePhaseTimer(const ScopedLifecyclePhaseTimer&) = delete;
+  ScopedLifecyclePhaseTimer& operator=(const ScopedLifecyclePhaseTimer&) =
+      delete;
+  ~ScopedLifecyclePhaseTimer() {
+    if (profiler_)
+      profiler_->AddPhaseTime(phase_, base::TimeTicks::Now() - start_);
+  }
+
+ private:
+  LifecyclePhaseProfiler* const profiler_;
+  const LifecyclePhaseProfiler::Phase phase_;
+  base::TimeTicks start_;
+};
+
 }  // namespace
 
 // The maximum number of updatePlugins iterations that should be done before
@@ -2011,8 +2155,9 @@ Color LocalFrameView::DocumentBackgroundColor() const {
   // by ViewPainter::paintBoxDecorationBackground.
   Color result = BaseBackgroundColor();
 
-  auto* settings = frame_->GetSettings();
-  if (settings && settings->GetForceDarkModeEnabled()) {
+  const Document* document = frame_->GetDocument();
+  if (document &&
+      GetDocumentDarkModeState(*document).force_dark_mode_enabled) {
     return Color::kBlack;
   }
 
@@ -2349,11 +2494,40 @@ bool LocalFrameView::UpdateLifecyclePhases(
           std::move(task).Run();
       });
     }
+
+    ForAllNonThrottledLocalFrameViews([](LocalFrameView& frame_view) {
+      UpdateCosmeticFilterSheet(*frame_view.GetFrame().GetDocument());
+    });
+  }
+
+  // Only full updates of the main frame are profiled.
+  LifecyclePhaseProfiler* profiler =
+      target_state == DocumentLifecycle::kPaintClean && frame_->IsMainFrame()
+          ? LifecyclePhaseProfiler::Get()
+          : nullptr;
+  if (profiler) {
+    const Document& document = *frame_->GetDocument();
+    uint8_t flags = 0;
+    if (GetDocumentDarkModeState(document).force_dark_mode_enabled)
+      flags |= LifecyclePhaseProfiler::kForceDarkMode;
+    if (document.GetTextAutosizer() &&
+        document.GetTextAutosizer()->PageNeedsAutosizing()) {
+      flags |= LifecyclePhaseProfiler::kTextAutosizing;
+    }
+    if (!(GetCosmeticPageCategories(document) & kCosmeticPageExempt) &&
+        !CosmeticFilterAllowsAds(document)) {
+      flags |= LifecyclePhaseProfiler::kCosmeticFiltering;
+    }
+    profiler->BeginFrame(GetLayoutView() && GetLayoutView()->NeedsLayout(),
+                         layout_subtree_root_list_.size(), flags);
   }
 
   // Run the lifecycle updates.
   UpdateLifecyclePhasesInternal(target_state);
 
+  if (profiler)
+    profiler->EndFrame();
+
   if (target_state == DocumentLifecycle::kPaintClean) {
     TRACE_EVENT0("blink", "LocalFrameView::DidFinishLifecycleUpdate");
 
@@ -2410,8 +2584,12 @@ void LocalFrameView::UpdateLifecyclePhasesInternal(
             DocumentLifecycle::kVisualUpdatePending);
       }
     }
-    bool run_more_lifecycle_phases =
-        RunStyleAndLayoutLifecyclePhases(target_state);
+    bool run_more_lifecycle_phases;
+    {
+      ScopedLifecyclePhaseTimer timer(LifecyclePhaseProfiler::kStyleAndLayout);
+      run_more_lifecycle_phases =
+          RunStyleAndLayoutLifecyclePhases(target_state);
+    }
     if (!run_more_lifecycle_phases)
       return;
     DCHECK(Lifecycle().GetState() >= DocumentLifecycle::kLayoutClean);
@@ -2428,7 +2606,11 @@ void LocalFrameView::UpdateLifecyclePhasesInternal(
 #endif
 
       DCHECK_GE(target_state, DocumentLifecycle::kAccessibilityClean);
-      run_more_lifecycle_phases = RunAccessibilityLifecyclePhase(target_state);
+      {
+        ScopedLifecyclePhaseTimer timer(LifecyclePhaseProfiler::kAccessibility);
+        run_more_lifecycle_phases =
+            RunAccessibilityLifecyclePhase(target_state);
+      }
       DCHECK(ShouldThrottleRendering() || !ExistingAXObjectCache() ||
              Lifecycle().GetState() == DocumentLifecycle::kAccessibilityClean);
       if (!run_more_lifecycle_phases)
@@ -2441,21 +2623,32 @@ void LocalFrameView::UpdateLifecyclePhasesInternal(
                                     inspector_update_layer_tree_event::Data,
                                     frame_.Get());
 
-      run_more_lifecycle_phases =
-          RunCompositingInputsLifecyclePhase(target_state);
+      {
+        ScopedLifecyclePhaseTimer timer(
+            LifecyclePhaseProfiler::kCompositingInputs);
+        run_more_lifecycle_phases =
+            RunCompositingInputsLifecyclePhase(target_state);
+      }
       if (!run_more_lifecycle_phases)
         return;
 
       // TODO(pdr): PrePaint should be under the "Paint" devtools timeline step
       // when CompositeAfterPaint is enabled.
-      run_more_lifecycle_phases = RunPrePaintLifecyclePhase(target_state);
+      {
+        ScopedLifecyclePhaseTimer timer(LifecyclePhaseProfiler::kPrePaint);
+        run_more_lifecycle_phases = RunPrePaintLifecyclePhase(target_state);
+      }
       DCHECK(ShouldThrottleRendering() ||
              Lifecycle().GetState() >= DocumentLifecycle::kPrePaintClean);
       if (ShouldThrottleRendering() || !run_more_lifecycle_phases)
         return;
 
-      run_more_lifecycle_phases =
-          RunCompositingAssignmentsLifecyclePhase(target_state);
+      {
+        ScopedLifecyclePhaseTimer timer(
+            LifecyclePhaseProfiler::kCompositingAssignments);
+        run_more_lifecycle_phases =
+            RunCompositingAssignmentsLifecyclePhase(target_state);
+      }
       if (!run_more_lifecycle_phases) {
         return;
       }
@@ -2508,7 +2701,10 @@ void LocalFrameView::UpdateLifecyclePhasesInternal(
 #endif
 
   DCHECK_EQ(target_state, DocumentLifecycle::kPaintClean);
-  RunPaintLifecyclePhase(PaintBenchmarkMode::kNormal);
+  {
+    ScopedLifecyclePhaseTimer timer(LifecyclePhaseProfiler::kPaint);
+    RunPaintLifecyclePhase(PaintBenchmarkMode::kNormal);
+  }
   DCHECK(ShouldThrottleRendering() || AnyFrameIsPrintingOrPaintingPreview() ||
          Lifecycle().GetState() == DocumentLifecycle::kPaintClean);
 
@@ -2936,11 +3132,10 @@ bool LocalFrameView::PaintTree(PaintBenchmarkMode benchmark_mode,
         visual_viewport_or_overlay_needs_repaint_) {
       GraphicsContext graphics_context(*paint_controller_);
 
-      if (Settings* settings = frame_->GetSettings()) {
-        graphics_context.SetDarkModeEnabled(
-            settings->GetForceDarkModeEnabled() &&
-            !GetLayoutView()->StyleRef().DarkColorScheme());
-      }
+      graphics_context.SetDarkModeEnabled(
+          GetDocumentDarkModeState(*frame_->GetDocument())
+              .force_dark_mode_enabled &&
+          !GetLayoutView()->StyleRef().DarkColorScheme());
 
       bool painted_full_screen_overlay = false;
       if (frame_->IsMainFrame()) {
@@ -55,6 +55,7 @@
 #include "third_party/blink/renderer/core/page/chrome_client.h"
 #include "third_party/blink/renderer/core/page/page.h"
 #include "third_party/blink/renderer/platform/geometry/int_rect.h"
+#include "third_party/blink/renderer/platform/instrumentation/tracing/trace_event.h"
 #include "third_party/blink/renderer/platform/network/network_utils.h"
 
 namespace blink {
@@ -585,6 +586,7 @@ bool TextAutosizer::HasLayoutInlineSizeChanged() const {
 // Static.
 void TextAutosizer::UpdatePageInfoInAllFrames(Frame* main_frame) {
   DCHECK(main_frame && main_frame == main_frame->Tree().Top());
+  TRACE_EVENT0("blink", "TextAutosizer::UpdatePageInfoInAllFrames");
   for (Frame* frame = main_frame; frame; frame = frame->Tree().TraverseNext()) {
     auto* local_frame = DynamicTo<LocalFrame>(frame);
     if (!local_frame)
@@ -686,8 +688,11 @@ void TextAutosizer::UpdatePageInfo() {
     if (page_info_.shared_info_ != previous_page_info.shared_info_ ||
         page_info_.accessibility_font_scale_factor_ !=
             previous_page_info.accessibility_font_scale_factor_ ||
-        page_info_.setting_enabled_ != previous_page_info.setting_enabled_)
+        page_info_.setting_enabled_ != previous_page_info.setting_enabled_) {
+      TRACE_EVENT_INSTANT0("blink", "TextAutosizer::PageInfoChanged",
+                           TRACE_EVENT_SCOPE_THREAD);
       SetAllTextNeedsLayout();
+    }
   } else if (previous_page_info.has_autosized_) {
     // If we are no longer autosizing the page, we won't do anything during the
     // next layout. Set all the multipliers back to 1 now.
@@ -703,6 +708,7 @@ IntSize TextAutosizer::WindowSize() const {
 }
 
 void TextAutosizer::ResetMultipliers() {
+  TRACE_EVENT0("blink", "TextAutosizer::ResetMultipliers");
   LayoutObject* layout_object = document_->GetLayoutView();
   while (layout_object) {
     if (const ComputedStyle* style = layout_object->Style()) {
@@ -714,6 +720,8 @@ void TextAutosizer::ResetMultipliers() {
 }
 
 void TextAutosizer::SetAllTextNeedsLayout(LayoutBlock* container) {
+  TRACE_EVENT1("blink", "TextAutosizer::SetAllTextNeedsLayout", "whole_page",
+               !container);
   if (!container)
     container = document_->GetLayoutView();
   LayoutObject* object = container;
@@ -1526,8 +1534,12 @@ void TextAutosizer::CheckSuperclusterConsistency() {
       fingerprint_mapper_.GetPotentiallyInconsistentSuperclusters();
   if (potentially_inconsistent_superclusters.IsEmpty())
     return;
+  TRACE_EVENT1("blink", "TextAutosizer::CheckSuperclusterConsistency",
+               "superclusters", potentially_inconsistent_superclusters.size());
 
   for (Supercluster* supercluster : potentially_inconsistent_superclusters) {
+    // The multiplier of a supercluster that has enough text is kept for as
+    // long as its fingerprint is: more text cannot change it.
     if (kHasEnoughText == supercluster->has_enough_text_to_autosize_)
       continue;
 
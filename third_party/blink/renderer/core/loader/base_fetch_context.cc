@@ -4,6 +4,8 @@
 
 #include "third_party/blink/renderer/core/loader/base_fetch_context.h"
 
+#include "base/no_destructor.h"
+#include "base/stl_util.h"
 #include "net/http/structured_headers.h"
 #include "services/network/public/cpp/request_mode.h"
 #include "third_party/blink/public/common/client_hints/client_hints.h"
@@ -18,11 +20,13 @@
 #include "third_party/blink/renderer/core/frame/web_feature.h"
 #include "third_party/blink/renderer/core/inspector/console_message.h"
 #include "third_party/blink/renderer/core/inspector/identifiers_factory.h"
+#include "third_party/blink/renderer/core/loader/built_in_block_list.h"
 #include "third_party/blink/renderer/core/loader/frame_client_hints_preferences_context.h"
 #include "third_party/blink/renderer/core/loader/subresource_filter.h"
 #include "third_party/blink/renderer/core/loader/subresource_redirect_util.h"
 #include "third_party/blink/renderer/platform/exported/wrapped_resource_request.h"
 #include "third_party/blink/renderer/platform/heap/heap.h"
+#include "third_party/blink/renderer/platform/heap/persistent.h"
 #include "third_party/blink/renderer/platform/loader/cors/cors.h"
 #include "third_party/blink/renderer/platform/loader/fetch/fetch_initiator_type_names.h"
 #include "third_party/blink/renderer/platform/loader/fetch/resource.h"
@@ -32,6 +36,8 @@
 #include "third_party/blink/renderer/platform/network/network_state_notifier.h"
 #include "third_party/blink/renderer/platform/weborigin/scheme_registry.h"
 #include "third_party/blink/renderer/platform/weborigin/security_policy.h"
+#include "third_party/blink/renderer/platform/wtf/std_lib_extras.h"
+#include "third_party/blink/renderer/platform/wtf/thread_specific.h"
 
 namespace {
 
@@ -51,6 +57,783 @@ const AtomicString SerializeHeaderString(std::string str) {
 
 namespace blink {
 
+namespace {
+
+// Query fragments that are only blocked in combination, see
+// kBlockedUrlParameterCombinations.
+enum UrlParameter : uint32_t {
+  kParamSw = 1 << 0,
+  kParamSh = 1 << 1,
+  kParamSah = 1 << 2,
+  kParamWw = 1 << 3,
+  kParamWh = 1 << 4,
+  kParamPl = 1 << 5,
+  kParamKey = 1 << 6,
+  kParamUuid = 1 << 7,
+  kParamId = 1 << 8,
+  kParamLm = 1 << 9,
+  kParamTs = 1 << 10,
+  kParamDn = 1 << 11,
+  kParamC = 1 << 12,
+  kParamR = 1 << 13,
+};
+
+struct SubstringRule {
+  const char* substring;
+  uint32_t categories;
+};
+
+// Substrings of the request (or page) host.
+const SubstringRule kHostRules[] = {
+    {"dev-nano.com", kHostAlwaysBlocked},
+    {"flashx", kHostFlashx | kHostPageAllowlisted | kHostSearchAllowlisted},
+    {".bannertrack.net", kHostAllowed},
+    {".adtrackers.net", kHostAllowed},
+    {".adclixx.net", kHostAllowed},
+    {".adnetasia.com", kHostAllowed},
+    {".foxnetworks.com", kHostAllowed},
+    {".clickability.com", kHostAllowed},
+    {"torrentz.", kHostAllowed},
+    {"imasdk.googleapis.com", kHostAllowed},
+    {"translate.googleapis.com", kHostAllowed},
+    {"www.google-analytics.com", kHostAllowed},
+    {".cloudfront.net", kHostAllowedForImages | kHostCloudFront},
+    {"push", kHostAllowedForImages | kHostAd},
+    {"google.", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"kiwibrowser.org", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"find.kiwi", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"ecosia.org", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"kiwisearchservices.com", kHostPageAllowlisted},
+    {"kiwisearchservices.net", kHostPageAllowlisted},
+    {"bing.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"bing.net", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"msn.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"lastpass.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"qwant.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"grammarly.com",
+     kHostPageAllowlisted | kHostSearchAllowlisted |
+     kHostSubresourceFilterExemptPage},
+    {"yandex.ru", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {".amazon.", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"yandex.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"startpage.com", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {".ebay.", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"search.yahoo.", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"geo.yahoo.", kHostPageAllowlisted | kHostSearchAllowlisted},
+    {"doubleclick.net", kHostPageAllowlisted},
+    {"eviltracker.net", kHostTracker},
+    {"trackersimulator.org", kHostTracker},
+    {"do-not-tracker.org", kHostTracker},
+    {"ad.aloodo.com", kHostTracker},
+    {"extremetracking.com", kHostTracker},
+    {"extreme-dm.com", kHostTracker},
+    {"cookieinformation.com", kHostCookieConsent | kHostAd},
+    {"cookie-script.com", kHostCookieConsent},
+    {"cookieassistant.com", kHostCookieConsent},
+    {"cookieconsent.com", kHostCookieConsent},
+    {"cookieconsent.silktide.com", kHostCookieConsent},
+    {"cookieq.com", kHostCookieConsent | kHostAd},
+    {"cookiereports.com", kHostCookieConsent},
+    {"consent.truste.com", kHostCookieConsent | kHostAd},
+    {"addthis", kHostAd},
+    {"chatango", kHostAd},
+    {"sharethis", kHostAd},
+    {"consensu.org", kHostAd},
+    {"consent", kHostAd},
+    {"iubenda.com", kHostAd},
+    {"r42tag.com", kHostAd},
+    {"tm.tradetracker.net", kHostAd},
+    {"abtasty", kHostAd},
+    {"scorecardresearch", kHostAd},
+    {"cedexis", kHostAd},
+    {"api.amplitude.com", kHostAd},
+    {"krxd.net", kHostAd},
+    {"acpm.fr", kHostAd},
+    {".plista.com", kHostAd},
+    {".hotjar.com", kHostAd},
+    {"trustarc", kHostAd},
+    {"cxense", kHostAd},
+    {"chartbeat", kHostAd},
+    {"quantserve", kHostAd},
+    {"crwdcntrl", kHostAd},
+    {"gemius", kHostAd},
+    {"aticdn", kHostAd},
+    {"xiti", kHostAd},
+    {"ati-host", kHostAd},
+    {"tiqcdn", kHostAd},
+    {"floodprincipal.com", kHostAd},
+    {"newrelic", kHostAd},
+    {".vntsm.com", kHostAd},
+    {"ownpage", kHostAd},
+    {"nuggad", kHostAd},
+    {"exelate", kHostAd},
+    {"goutee.top", kHostAd},
+    {"digidip.net", kHostAd},
+    {"tradelab.fr", kHostAd},
+    {"tr.snapchat.com", kHostAd},
+    {"exelator", kHostAd},
+    {"minute.ly", kHostAd},
+    {"ligatus", kHostAd},
+    {"hubvisor", kHostAd},
+    {"outbrain", kHostAd},
+    {"taboola", kHostAd},
+    {"mediavoice", kHostAd},
+    {"criteo", kHostAd},
+    {"demdex", kHostAd},
+    {"viglink", kHostAd},
+    {"segment.com", kHostAd},
+    {"tagcommander", kHostAd},
+    {"edigitalsurvey", kHostAd},
+    {"cookiematch", kHostAd},
+    {"seedtag", kHostAd},
+    {"estat.com", kHostAd},
+    {"zebestof.com", kHostAd},
+    {"kxcdn.com", kHostAd},
+    {"ccmbg.com", kHostAd},
+    {"exosrv.com", kHostAd},
+    {"tubecorporate", kHostAd},
+    {"evidon", kHostAd},
+    {"optimizely.com", kHostAd},
+    {"edigitalsurvey.com", kHostAd},
+    {"condenastdigital.com", kHostAd},
+    {"bounceexchange.com", kHostAd},
+    {"zqtk.net", kHostAd},
+    {"yuyue", kHostAd},
+    {"ytdksb.com", kHostAd},
+    {"demdex.net", kHostAd},
+    {"adobedtm.com", kHostAd},
+    {"tvsquared.com", kHostAd},
+    {"metric", kHostAd},
+    {"lijit", kHostAd},
+    {"analytics", kHostAd},
+    {"adsco.re", kHostAd},
+    {"akstat", kHostAd},
+    {"onthe.io", kHostAd},
+    {"tns-counter.ru", kHostAd},
+    {"onesignal", kHostAd},
+    {"mgid", kHostAd},
+    {"adblockanalytics", kHostAd},
+    {"an.yandex.ru", kHostAd},
+    {"browsiprod", kHostAd},
+    {".porn555.com", kHostPorn555},
+    {"bild.de", kHostSubresourceFilterExemptPage},
+    {"postimees.ee", kHostSubresourceFilterExemptPage},
+    {"espn.com", kHostSubresourceFilterExemptPage},
+    {"api.ero-advertising.com", kHostEroAdvertising},
+    {"xvideos-cdn.com", kHostSubresourceFilterExempt},
+};
+
+// Substrings of the request path.
+const SubstringRule kPathRules[] = {
+    {"cast_sender.js", kPathAllowedForScripts},
+    {"adblock.js", kPathAllowedForScripts},
+    {"ads.js", kPathAllowedForScripts},
+    {"trustguard.js", kPathAllowedForScripts},
+    {"videojs.ads.", kPathAllowed},
+    {"watch.xml", kPathPopunder},
+    {"ads.xml", kPathBlocked},
+    {"aabv121.php", kPathAd},
+    {"apu.php", kPathAd},
+    {"adlift", kPathAd},
+    {"smartbanner", kPathAd},
+    {"gampad/ads", kPathAd},
+    {"gpt/pubads", kPathAd},
+    {"notice.php", kPathAd},
+    {"interstitial.php", kPathAd},
+    {"1234.js", kPathAd},
+    {"ama.js", kPathAd},
+    {"/adServe/banners", kPathAd},
+    {"afu.php", kPathAd},
+    {"speed.php", kPathAd},
+    {"nwm-dbh.min3.js", kPathAd},
+    {"prebid", kPathAd},
+    {"stats.php", kPathAd},
+    {"zcredirect", kPathAd},
+    {".pop.js", kPathAd},
+    {"jwplayer", kPathAllowedOnCloudFront},
+    {"app-min.js", kPathAllowedOnCloudFront},
+    {"jquery", kPathAllowedOnCloudFront},
+    {"sw.js", kPathServiceWorker},
+    {"get.php", kPathEroAdvertising},
+};
+
+const SubstringRule kUrlParameterRules[] = {
+    {"&sw=", kParamSw},
+    {"&sh=", kParamSh},
+    {"&sah=", kParamSah},
+    {"&ww=", kParamWw},
+    {"&wh=", kParamWh},
+    {"&pl=", kParamPl},
+    {"?key=", kParamKey},
+    {"&uuid=", kParamUuid},
+    {"&id=", kParamId},
+    {"&lm=", kParamLm},
+    {"&ts=", kParamTs},
+    {"&dn=", kParamDn},
+    {"&c=", kParamC},
+    {"&r=", kParamR},
+};
+
+const uint32_t kBlockedUrlParameterCombinations[] = {
+    kParamSw | kParamSh | kParamSah | kParamWw | kParamWh | kParamPl,
+    kParamKey | kParamUuid,
+    kParamId | kParamLm | kParamTs | kParamDn,
+    kParamId | kParamDn | kParamC | kParamR,
+};
+
+// A substring of the full request URL, blocked while the subresource filter
+// is active. When |site| is set the rule only applies to requests whose host
+// is |site| or contains ".|site|".
+struct BlockedUrlRule {
+  const char* substring;
+  const char* site;
+};
+
+// Generated by gen_base_fetch_context.php
+const BlockedUrlRule kBlockedUrlRules[] = {
+    {"sleeknotestaticcontent.sleeknote.com", nullptr},  // newsletter
+    {"js.driftt.com/include/", nullptr},  // newsletter
+    {"assets.ubembed.com/universalscript/", nullptr},  // newsletter
+    {"lightboxcdn.com/vendor/", nullptr},  // newsletter
+    {"mailocator.net/_/", nullptr},  // newsletter
+    {"cdn1.pdmntn.com", nullptr},  // newsletter
+    {"static.mailerlite.com/js", nullptr},  // newsletter
+    {"pmdstatic.net/bundle.php", nullptr},  // newsletter
+    {"front.optimonk.com/public/", nullptr},  // newsletter
+    {"/wp-content/plugins/newsletter-leads", nullptr},  // newsletter
+    {"downloads.mailchimp.com/js/signup-forms", nullptr},  // newsletter
+    {"conduit.mailchimpapp.com/js/stores", nullptr},  // newsletter
+    {"a.optmnstr.com/app/js/", nullptr},  // newsletter
+    {"getsocial.io/client/", nullptr},  // newsletter
+    {"static.ctctcdn.com/js/signup-form-widget", nullptr},  // newsletter
+    {"cdn.justuno.com/mwgt", nullptr},  // newsletter
+    {"a.mailmunch.co/app/", nullptr},  // newsletter
+    {"/newsletterPopup.js", nullptr},  // newsletter
+    {"/pmgnews/overlay/newsletter", nullptr},  // newsletter
+    {"dotmailer-surveys.com/scripts/survey.js", nullptr},  // newsletter
+    {"yieldify.com/yieldify/code.js", nullptr},  // newsletter
+    {"widget.privy.com/assets/widget.js", nullptr},  // newsletter
+    {"sumo.b-cdn.net", nullptr},  // newsletter
+    {"chimpstatic.com/mcjs-connected/js/users", nullptr},  // newsletter
+    {"assets.pcrl.co/js/", nullptr},  // newsletter
+    {"/wp-content/plugins/email-subscribers/widget/es-widget-page.js", nullptr},  // newsletter
+    {"youlead.pl/Scripts/Dynamic.js", nullptr},  // newsletter
+    {"m8.mailplus.nl/genericservice", nullptr},  // newsletter
+    {"restapi.mailplus.nl/integrationservice", nullptr},  // newsletter
+    {"snrcdn.net/sdk/", nullptr},  // newsletter
+    {"static.dynamicyield.com/scripts/", nullptr},  // newsletter
+    {"static.newsletter2go.com/utils.js", nullptr},  // newsletter
+    {"/widget/ecNewsletterPopup/", nullptr},  // newsletter
+    {"a.optmstr.com/app/js/", nullptr},  // newsletter
+    {"api.autopilothq.com/anywhere/", nullptr},  // newsletter
+    {"c.salecycle.com/osr/config", nullptr},  // newsletter
+    {"/wp-content/plugins/thrive-leads/", nullptr},  // newsletter
+    {"/wp-content/plugins/bloom/", nullptr},  // newsletter
+    {"js.hsleadflows.net/leadflows.js", nullptr},  // newsletter
+    {"/clientlib-newsletter.js", nullptr},  // newsletter
+    {"c.lytics.io/static/pathfora", nullptr},  // newsletter
+    {"email-signup-form-popup.js", nullptr},  // newsletter
+    {"netpeak.cloud/source/js", nullptr},  // newsletter
+    {"bunting.com/call", nullptr},  // newsletter
+    {"cdn.connectif.cloud/cl1/client-script/", nullptr},  // newsletter
+    {"/essb-optin-booster.js", nullptr},  // newsletter
+    {"f.convertkit.com", nullptr},  // newsletter
+    {"assets.bounceexchange.com/assets/smart-tags", nullptr},  // newsletter
+    {"api.morningcatch.net", nullptr},  // newsletter
+    {"shopify.privy.com/widget.js", nullptr},  // newsletter
+    {"static.klaviyo.com/onsite/js/vendors~signupForms", nullptr},  // newsletter
+    {"load.sumo.com", nullptr},  // newsletter
+    {"cdn.listrakbi.com/scripts/script.js", nullptr},  // newsletter
+    {"/wp-content/plugins/dreamgrow-scroll-triggered-box/", nullptr},  // newsletter
+    {"d3bo67muzbfgtl.cloudfront.net/edrone", nullptr},  // newsletter
+    {"/newsletter_modals.min.", nullptr},  // newsletter
+    {"s.m3medical.com/popup/popup.production.js", "m3medical.com"},  // newsletter
+    {"ajax-open-layer?layerID=/nlsublay", "hessnatur.com"},  // newsletter
+    {"NotificationDisclaimerControl.js", "vontobel.com"},  // newsletter
+    {"list-builder.js", "wanderlust.co.uk"},  // newsletter
+    {"/amd_modules/newsletter-hover", "webmd.com"},  // newsletter
+    {"/politica-privacidade/lightbox", "toysrus.pt"},  // newsletter
+    {"nebula-cdn.kampyle.com", nullptr},  // survey
+    {"turbo.qualaroo.com/c.js", nullptr},  // survey
+    {"scripts.psyma.com/layer_question.php", nullptr},  // survey
+    {"w.usabilla.com", nullptr},  // survey
+    {"static.hotjar.com/c/hotjar", nullptr},  // survey
+    {"scripts.psyma.com/html/layer/json_question.php", nullptr},  // survey
+    {"visualwebsiteoptimizer.com/va_survey", nullptr},  // survey
+    {"gateway.answerscloud.com", nullptr},  // survey
+    {"st.getsitecontrol.com/main/runtime/", nullptr},  // survey
+    {"survey.g.doubleclick.net/survey", nullptr},  // survey
+    {"/opiniac.js", nullptr},  // survey
+    {"ssl.ceneo.pl/shops/", nullptr},  // survey
+    {"cloud.netquest.sk/scripts/widget", nullptr},  // survey
+    {"storage.googleapis.com/outfox/ocs/surveys/", nullptr},  // survey
+    {"kameleoon.eu/kameleoon.js", nullptr},  // survey
+    {"invitation.opinionbar.com/wit/popups", nullptr},  // survey
+    {"neads.delivery/opinion-seed-embed.js", nullptr},  // survey
+    {"collect.mopinion.com/assets/surveys/", nullptr},  // survey
+    {"/runtimejs/dist/survey/js/survey.js", nullptr},  // survey
+    {"surveygizmobeacon.s3.amazonaws.com/beaconconfigs/", nullptr},  // survey
+    {"cpx.smind.hr/Log/LogData", nullptr},  // survey
+    {"widget.surveymonkey.com/collect", nullptr},  // survey
+    {"cdn.feedbackify.com/f.js", nullptr},  // survey
+    {"invitation.opinionbar.com/popups", nullptr},  // survey
+    {"/bundles/Scripts/OpinionLab.js", nullptr},  // survey
+    {"survey.nuggad.net/c/layer-html", nullptr},  // survey
+    {"ips-invite.iperceptions.com/invitations", nullptr},  // survey
+    {"/oo_engine.min.js", nullptr},  // survey
+    {"userzoom.com/feedback", nullptr},  // survey
+    {"invite.leanlab.co/invite/invite.js", nullptr},  // survey
+    {"userreport.com/newsquest/launcher.js", nullptr},  // survey
+    {"siteintercept.qualtrics.com", nullptr},  // survey
+    {"/vendor/opinionlab/", "lenovo.com"},  // survey
+    {"widget.manychat.com", nullptr},  // chat
+    {"vivocha.com/a/", nullptr},  // chat
+    {"altocloud-sdk.com/ac.js", nullptr},  // chat
+    {"cdn.datahub.sempro.ai", nullptr},  // chat
+    {"whatshelp.io/widget-send-button", nullptr},  // chat
+    {"smartsuppchat.com/loader.js", nullptr},  // chat
+    {"chat.wmy.io/widget", nullptr},  // chat
+    {"crdx-feedback.appspot.com", nullptr},  // chat
+    {"widget.whisbi.com", nullptr},  // chat
+    {"mylivechat.com/chatinline", nullptr},  // chat
+    {"static.zdassets.com/web_widget/", nullptr},  // chat
+    {"cdn-widget.callpage.io", nullptr},  // chat
+    {"/wp-content/plugins/makleraccess/assets/js/chat.", nullptr},  // chat
+    {"widget.replain.cc/dist/client.js", nullptr},  // chat
+    {"image.providesupport.com", nullptr},  // chat
+    {"tinka.t-mobile.at", nullptr},  // chat
+    {"userlike-cdn-widgets.s3-eu-west-1.amazonaws.com", nullptr},  // chat
+    {"static.helloumi.com/umiwebcha", nullptr},  // chat
+    {"embed.tawk.to", nullptr},  // chat
+    {"widget.uservoice.com", nullptr},  // chat
+    {"static.olark.com/jsclient", nullptr},  // chat
+    {"xfbml.customerchat.js", nullptr},  // chat
+    {"v2.zopim.com", nullptr},  // chat
+    {"widget.intercom.io/widget", nullptr},  // chat
+    {"/lz/server.php", nullptr},  // chat
+    {"cdn.livechatinc.com/tracking.js", nullptr},  // chat
+    {"widgets.trustedshops.com", nullptr},  // chat
+    {"comm100.com/chatserver", nullptr},  // chat
+    {"salesiq.zoho.com/widget", nullptr},  // chat
+    {"www.czater.pl/assets/modules/chat/js/chat.js", nullptr},  // chat
+    {"node.unifiedfactory.com", nullptr},  // chat
+    {"cdn.kustomerapp.com/cw", nullptr},  // chat
+    {"f01.inbenta.com", nullptr},  // chat
+    {"static.classistatic.de/oplab/oo-v", nullptr},  // chat
+    {"lc.iadvize.com/js/dist/livechat.js", nullptr},  // chat
+    {"chatboxes.doyoudreamup.com/Prod/", nullptr},  // chat
+    {"chat.kundo.se/chat/", nullptr},  // chat
+    {".vo.msecnd.net/ius-", nullptr},  // chat
+    {"robincontentdesktop.blob.core.windows.net/external/robin/", nullptr},  // chat
+    {"code.jivosite.com", nullptr},  // chat
+    {"widgets.mango-office.ru", nullptr},  // chat
+    {"firebaseapp.com/cfc/chat.js", nullptr},  // chat
+    {"static-ssl.kundo.se/embed.js", nullptr},  // chat
+    {"lc.iadvize.com/iadvize.js", nullptr},  // chat
+    {"s.acquire.io", nullptr},  // chat
+    {"assets.livecall.io/assets/livecall-widget.js", nullptr},  // chat
+    {"/chatlio/chatlio.js", nullptr},  // chat
+    {"app.purechat.com/VisitorWidget", nullptr},  // chat
+    {"widget.customerly.io/widget", nullptr},  // chat
+    {"limetalk.com/js/widget.js", nullptr},  // chat
+    {"code.snapengage.com/js", nullptr},  // chat
+    {"chatbot.api.nn-group.com", nullptr},  // chat
+    {"wchat.freshchat.com", nullptr},  // chat
+    {"lpcdn.lpsnmedia.net/le_re/", nullptr},  // chat
+    {"static.userback.io/widget", nullptr},  // chat
+    {"track.freecallinc.com/freecall.js", nullptr},  // chat
+    {"addthis.com/static/layers", nullptr},  // chat
+    {"asset.gomoxie.solutions/concierge/synnex/client/", nullptr},  // chat
+    {"gateway.foresee.com/code/", nullptr},  // chat
+    {"tbcdnwidgetsprod.azureedge.net/widget/", nullptr},  // chat
+    {"/onlinechat/js_chat/chat_functions.js", nullptr},  // chat
+    {"/onlinechat/chat_live_interface.php", nullptr},  // chat
+    {"app.five9.com/consoles/SocialWidget/", nullptr},  // chat
+    {"dragoman.com/livechat/", nullptr},  // chat
+    {"js.usemessages.com/conversations-embed.js", nullptr},  // chat
+    {".tidiochat.com", nullptr},  // chat
+    {"cdn.chatio-static.com/widget/", nullptr},  // chat
+    {"smilee.io/assets/javascripts/cobrowse.js", nullptr},  // chat
+    {"/javascript/livechat.js", nullptr},  // chat
+    {"vmss.boldchat.com/aid/", nullptr},  // chat
+    {"cdn.elev.io/sdk/bootloader/v4/elevio-bootloader.js", nullptr},  // chat
+    {"service.force.com/embeddedservice/", nullptr},  // chat
+    {"my.salesforce.com/embeddedservice/", nullptr},  // chat
+    {"sidecar.gitter.im/dist/", nullptr},  // chat
+    {"client.crisp.chat", nullptr},  // chat
+    {"snapengage.com/cdn/js/", nullptr},  // chat
+    {"static.goqubit.com/smartserve", nullptr},  // chat
+    {"/jquery.livehelp.js", nullptr},  // chat
+    {"config.gorgias.io", nullptr},  // chat
+    {"chatserver.comm100.com", nullptr},  // chat
+    {"sb.monetate.net/img/", nullptr},  // chat
+    {"realperson.de/system/scripts/loadchatmodul.js", nullptr},  // chat
+    {"beacon-v2.helpscout.net", nullptr},  // chat
+    {"wm-livechat-prod-dot-watermelonmessenger.appspot.com", nullptr},  // chat
+    {"widget.destygo.com/destygo-webchat.js", nullptr},  // chat
+    {"assets.freshservice.com/widget", nullptr},  // chat
+    {"calendly.com/assets/external/widget.js", nullptr},  // chat
+    {"/uisdk/botchat.js", nullptr},  // chat
+    {"chat-widget.thulium.com/app/chat-loader.js", nullptr},  // chat
+    {"assets.kayako.com/messenger", nullptr},  // chat
+    {"static.landbot.io/landbot-widget", nullptr},  // chat
+    {"projects.elitechnology.com/jsprojects/pggm/client", nullptr},  // chat
+    {"humany.net/default/embed.js", nullptr},  // chat
+    {"/js/common/tokywoky-", nullptr},  // chat
+    {"widget.dixa.io/assets/scripts", nullptr},  // chat
+    {"support.qualityunit.com/scripts/button.php", nullptr},  // chat
+    {"/kapturesupport.nojquery.min.js", nullptr},  // chat
+    {"/chat-widget/clientLibs.min.", nullptr},  // chat
+    {"call.chatra.io/chatra.js", nullptr},  // chat
+    {"api.asksid.ai/akzo-webchat", nullptr},  // chat
+    {"/js/chatPanel.js", nullptr},  // chat
+    {"videocall.te-ex.ru/js/richcall.widget.js", nullptr},  // chat
+    {"chatbot.inbenta.com", nullptr},  // chat
+    {"wm-livechat-2-prod-dot-watermelonmessenger.appspot.com", nullptr},  // chat
+    {"static.triptease.io/client-integrations", nullptr},  // chat
+    {"freshdesk.com/widget/freshwidget.js", nullptr},  // chat
+    {"/livehelperchat-master/lhc_web/", nullptr},  // chat
+    {"verbox.ru/support/support.js", nullptr},  // chat
+    {"storage.googleapis.com/livezhat", nullptr},  // chat
+    {"subiz.com/static/js/app.js", nullptr},  // chat
+    {"w.usabilla.com", nullptr},  // chat
+    {"cdn.rlets.com/capture_configs", nullptr},  // chat
+    {"reachlocallivechat.com/scripts/dyns.js", nullptr},  // chat
+    {"webchat.big-box.net/chat", nullptr},  // chat
+    {"cdn.gubagoo.io/toolbars", nullptr},  // chat
+    {"userreport.com/userreport.js", nullptr},  // chat
+    {"widget.alphablues.com/widget/alphachat.js", nullptr},  // chat
+    {"inbenta.com/assets/js/inbenta", nullptr},  // chat
+    {"sdk.inbenta.io/chatbot", nullptr},  // chat
+    {"liveagent.se/scripts/track.js", nullptr},  // chat
+    {"/NetworkContacts.AskMeSEM.WebChat/", nullptr},  // chat
+    {"googleapis.com/snapengage-eu/js", nullptr},  // chat
+    {"messenger.ngageics.com", nullptr},  // chat
+    {"justanswer.com/js/ja-gadget-virtual-assistant", nullptr},  // chat
+    {"par.salesforceliveagent.com", nullptr},  // chat
+    {"scripts/pls.chat", "plaisio.gr"},  // chat
+    {"sa_emb/va.min.js", "sainsburysbank.co.uk"},  // chat
+    {"/contact-us.js", "vocabulix.com"},  // chat
+    {"/cm-app/latest/cm-app.min.js", "ibm.com"},  // chat
+    {"/common/digitaladvisor/cm-app/", "ibm.com"},  // chat
+    {"/helpdesk_widget/widget.js", "redmineup.com"},  // chat
+    {"snap.snapcall.io", "ter.sncf.com"},  // chat
+    {"chat.website-bereinigung.de/resource.php", "website-bereinigung.de"},  // chat
+    {"support.muziker.com/scripts/track.js", "muziker.nl"},  // chat
+    {"/crm/site_button", "digistar.vn"},  // chat
+    {"custom-content-collection", "analog.com"},  // chat
+    {"ssl.heureka.cz/direct/i/gjs.php", nullptr},  // rating
+    {"opineo.pl/shop/slider.js", nullptr},  // rating
+    {"https://static.arukereso.hu/widget/presenter.js", nullptr},  // rating
+    {"cpx.smind.si/Log/", nullptr},  // rating
+    {"widget.trustpilot.com", nullptr},  // rating
+    {"dash.reviews.co.uk/widget/float.js", nullptr},  // rating
+    {"dashboard.webwinkelkeur.nl/webshops/sidebar.js", nullptr},  // rating
+    {"staticw2.yotpo.com", nullptr},  // rating
+    {"cdn.trustami.com/widgetapi", nullptr},  // rating
+    {"cdn.ywxi.net/js/", nullptr},  // rating
+    {"monaviscompte.fr/widget", nullptr},  // rating
+    {"nsg.symantec.com/Web/Seal/", nullptr},  // rating
+    {"widget.reviews.co.uk/rich-snippet-reviews-widgets/dist.js", nullptr},  // rating
+    {"static.pazaruvaj.com/widget", nullptr},  // rating
+    {"avis-verifies.com/js/widget", nullptr},  // rating
+    {"cdn.p-n.io/pushly", nullptr},  // push
+    {"app3.emlgrid.com/static/sm.js", nullptr},  // push
+    {"webpush-desktop.chunk.js", nullptr},  // push
+    {"push4site.com/Static/Script/", nullptr},  // push
+    {"cdn.ghostmonitor.com", nullptr},  // push
+    {"notify.hindustantimes.com", nullptr},  // push
+    {"webpush.interia.pl", nullptr},  // push
+    {"cdn.izooto.com/scripts/", nullptr},  // push
+    {"js.pusher.com/", nullptr},  // push
+    {"push-ad.com/integration.php", nullptr},  // push
+    {"cdn.pushassist.com/account/assets/", nullptr},  // push
+    {"gadgets.ndtv.com/static/desktop/js/notification_popup-min.js", nullptr},  // push
+    {"pusherism.com", nullptr},  // push
+    {"pushnest.com", nullptr},  // push
+    {"getpushmonkey.com/sdk/config", nullptr},  // push
+    {"cdn.onesignal.com/sdks/OneSignalSDK.js", nullptr},  // push
+    {"pushpushgo.com/js", nullptr},  // push
+    {"cdn.sendpulse.com", nullptr},  // push
+    {"salesmanago.pl/static/sm.js", nullptr},  // push
+    {"cdn.pushcrew.com", nullptr},  // push
+    {"/streamlined-push-plugin.production.min.js", nullptr},  // push
+    {"app.push-ad.com", nullptr},  // push
+    {"/pushnotification/service-worker-script.js", nullptr},  // push
+    {"/sp-push-worker.js", nullptr},  // push
+    {"95p5qep4aq.com", nullptr},  // push
+    {"snrcdn.net/sdk/", nullptr},  // push
+    {"via.batch.com", nullptr},  // push
+    {"wonderpush.com/sdk/", nullptr},  // push
+    {"clientcdn.pushengage.com", nullptr},  // push
+    {"web-sdk.urbanairship.com/notify/", nullptr},  // push
+    {"api.sociaplus.com", nullptr},  // push
+    {"/plugins/tmx-push/", nullptr},  // push
+    {"/firebase-messaging.js", nullptr},  // push
+    {"pushno.com", nullptr},  // push
+    {"pushwhy.com", nullptr},  // push
+    {"pushame.com", nullptr},  // push
+    {"voirfilms.ws/sw.js", nullptr},  // push
+    {"siteswithcontent.com/js/push", nullptr},  // push
+    {"cdn.moengage.com/webpush", nullptr},  // push
+    {"brandflow.net/static/general/push-init-code.js", nullptr},  // push
+    {"static.cleverpush.com/channel/loader", nullptr},  // push
+    {"static.getback.ch/clients", nullptr},  // push
+    {"/PushNotifications.", nullptr},  // push
+    {"cdn.pushowl.com/sdks", nullptr},  // push
+    {"accengage.net/pushweb/", nullptr},  // push
+    {"cdn.foxpush.net/sdk/foxpush_SDK", nullptr},  // push
+    {"js.appboycdn.com/web-sdk/", nullptr},  // push
+    {"cdn.taboola.com/libtrc/tmg-network/loader.js", nullptr},  // push
+    {"/js/push_subscription.js", nullptr},  // push
+    {"pushwoosh.com/webpush", nullptr},  // push
+    {"push_service-worker.js", nullptr},  // push
+    {"0_ghpush_client.js", nullptr},  // push
+    {"pastoupt.com/ntfc.php", nullptr},  // push
+    {"pushsar.com/ntfc.php", nullptr},  // push
+    {"sdk.jeeng.com", nullptr},  // push
+    {"gstatic.com/firebasejs/", nullptr},  // push
+    {"d3bo67muzbfgtl.cloudfront.net/edrone", nullptr},  // push
+    {"/sw.js", "pinterest.com"},  // push
+    {"/public/spartanien/js/sw_handler", "spartanien.de"},  // push
+    {"/pushes/notification.js", "rt.com"},  // push
+    {"/js/subscriber", "mitula.pt"},  // push
+    {"/firebase.js", "alibaba.com"},  // push
+    {"/sw.js", "1337x.is"},  // push
+    {"/sw.js", "1337x.to"},  // push
+    {"push-main.js", "ndtv.com"},  // push
+    {"/js/adNotice.js", "hardwarezone.com.sg"},  // push
+    {"/push/", "tut.by"},  // push
+    {"/firebase.min.js", "azoresgetaways.com"},  // push
+    {"client-.js", "hoerbuch.us"},  // push
+    {"/geoPosition.min.js", nullptr},  // location
+    {"stat.profession.hu/static/js/geoPosition.js", nullptr},  // location
+    {"nero.live/tags/mwa.min.js", nullptr},  // location
+    {"z.moatads.com", nullptr},  // location
+    {"wonderpush.com/sdk/", nullptr},  // location
+    {"abs.proxistore.com", nullptr},  // location
+    {"cdn.hexago.io/tag/js/hexago.min.js", nullptr},  // location
+    {"/typo3temp/compressor/geoloc-", nullptr},  // location
+    {"/wp-content/plugins/strathcom-personalization/", nullptr},  // location
+    {"/web/modules/gps_location.js", nullptr},  // location
+    {"/lib/geoPosition/geoPosition.js", nullptr},  // location
+    {"/Byggmax_Geolocation/js/closest-store-selector.js", "byggmax.no"},  // location
+    {"/clientlibs/foundation/personalization/", "dhl.de"},  // location
+    {"/sat24mylocation.", "sat24.com"},  // location
+    {"api-maps.yandex.ru", "mcdonalds.ru"},  // location
+    {"nearest-place.js", "magniflex.cz"},  // location
+    {"nearestFilialeService.js", "intesasanpaolo.com"},  // location
+    {"/atelier.min.js", "reseau-canope.fr"},  // location
+    {"advinapps.com/ads-async.js", nullptr},  // app
+    {"cdn.branch.io/branch-latest.min.js", nullptr},  // app
+    {"browser-update.org/update.show.min.js", nullptr},  // app
+    {"js.convertflow.co/production/websites", nullptr},  // app
+    {"/jquery.bxSlider.min.js", "mosalingua.com"},  // app
+    {"NotificationDisclaimerControl.js", "vontobel.com"},  // app
+    {"fancy-bar.js", "designtaxi.com"},  // app
+    {"translate.googleapis.com/element/TE_", nullptr},  // translation
+    {"/wp-content/plugins/google-language-translator/", nullptr},  // translation
+    {"/back-to-top.js", nullptr},  // top
+    {"/wp-content/plugins/hms-navigationarrows/", nullptr},  // top
+    {"/scroll-to-top.min.js", nullptr},  // top
+    {"/catchresponsive-scrollup.min.js", nullptr},  // top
+    {"/wp-content/plugins/jcwp-scroll-to-top/", nullptr},  // top
+    {"apps.veedio.it/js/videobox", nullptr},  // video
+    {"/responsive-player/video-feature-sticky.js", nullptr},  // video
+    {"s-pt.ppstatic.pl/p/js/regionalne/plywajace_wideo.js", nullptr},  // video
+    {"/js/compiled/atoms/article/sticky-video.js", nullptr},  // video
+    {"sdk.digitalbees.it/jssdk.js", nullptr},  // video
+    {"mol-adverts.js", "dailymail.co.uk"},  // video
+    {"w.usabilla.com", nullptr},  // signup
+    {"cdn.tinypass.com/api/tinypass.min.js", nullptr},  // subscribe
+    {"tag.rightmessage.com", nullptr},  // subscribe
+    {"&zone_id=", nullptr},
+    {"/zone?pub=", nullptr},
+    {".php?OAID=", nullptr},
+    {"/jump/next.php?r=", nullptr},
+    {"improving.duckduckgo.com", nullptr},
+    {"tribdss.com/meter/assets/latarc-reaction", "latimes.com"},  // subscribe
+};
+
+// Hosts that are never filtered. Compared for equality, unlike kHostRules.
+const char* const kAllowedExactHosts[] = {
+    "zoover.adnetasia.com", "partnerads.ysm.yahoo.com", "a.livesportmedia.eu",
+    "promote.pair.com",     "ad.mail.ru",               "adn.ebay.com",
+    "advertising.aol.com",  "www.gstatic.com",          "juicyads.com",
+    "ecosia.org",           "www.ecosia.org",           "cdn.ecosia.org",
+};
+
+}  // namespace
+
+BuiltInBlockList::BuiltInBlockList() {
+  for (const SubstringRule& rule : kHostRules)
+    hosts.AddPattern(rule.substring, rule.categories);
+  for (const SubstringRule& rule : kPathRules)
+    paths.AddPattern(rule.substring, rule.categories);
+  for (const SubstringRule& rule : kUrlParameterRules)
+    url_parameters.AddPattern(rule.substring, rule.categories);
+  // Values are 1-based indices into kBlockedUrlRules.
+  for (wtf_size_t i = 0; i < base::size(kBlockedUrlRules); ++i)
+    urls.AddPattern(kBlockedUrlRules[i].substring, i + 1);
+  hosts.Build();
+  paths.Build();
+  url_parameters.Build();
+  urls.Build();
+}
+
+const BuiltInBlockList& GetBuiltInBlockList() {
+  static const base::NoDestructor<BuiltInBlockList> block_list;
+  return *block_list;
+}
+
+namespace {
+
+// Same as |host == site || host.Contains("." + site)|, without building the
+// dotted string.
+bool HostMatchesSite(const String& host, const char* site) {
+  if (host == site)
+    return true;
+  for (wtf_size_t pos = host.Find(site, 1); pos != kNotFound;
+       pos = host.Find(site, pos + 1)) {
+    if (host[pos - 1] == '.')
+      return true;
+  }
+  return false;
+}
+
+// Block list decision for the page that issues a request.
+struct PageDecision {
+  bool has_host = false;
+  uint32_t categories = 0;
+};
+
+// The page URL of a fetch context does not change during the lifetime of a
+// document, and all its requests see the same KURL string, so the page-level
+// decision is computed once per document and then found by a pointer
+// comparison. A few entries per thread cover frames loading concurrently.
+class PageDecisionCache {
+  USING_FAST_MALLOC(PageDecisionCache);
+
+ public:
+  PageDecision Get(const KURL& page_url, const BuiltInBlockList& block_list) {
+    const String& url_string = page_url.GetString();
+    for (const Entry& entry : entries_) {
+      if (entry.page_url.Impl() == url_string.Impl() ||
+          entry.page_url == url_string) {
+        return entry.decision;
+      }
+    }
+
+    Entry& entry = entries_[next_entry_];
+    next_entry_ = (next_entry_ + 1) % kSize;
+    const String page_host = page_url.Host();
+    entry.page_url = url_string;
+    entry.decision.has_host = !page_host.IsNull();
+    entry.decision.categories = block_list.hosts.Match(page_host);
+    return entry.decision;
+  }
+
+ private:
+  static constexpr wtf_size_t kSize = 4;
+
+  struct Entry {
+    String page_url;
+    PageDecision decision;
+  };
+
+  Entry entries_[kSize];
+  wtf_size_t next_entry_ = 0;
+};
+
+PageDecisionCache& GetPageDecisionCache() {
+  DEFINE_THREAD_SAFE_STATIC_LOCAL(ThreadSpecific<PageDecisionCache>, cache,
+                                  ());
+  return *cache;
+}
+
+// Whether the subresource filter of a document filters ads at all. This is
+// probed with a well-known ad URL. The answer is fixed for the lifetime of a
+// SubresourceFilter, which is recreated when the activation state changes, so
+// on the main thread it is cached per filter instead of probing once per
+// request.
+class AdFilteringStateCache {
+  USING_FAST_MALLOC(AdFilteringStateCache);
+
+ public:
+  bool IsActive(SubresourceFilter* filter,
+                ReportingDisposition reporting_disposition) {
+    for (const Entry& entry : entries_) {
+      if (entry.filter.Get() == filter)
+        return entry.active;
+    }
+    Entry& entry = entries_[next_entry_];
+    next_entry_ = (next_entry_ + 1) % kSize;
+    entry.filter = filter;
+    entry.active = Probe(filter, reporting_disposition);
+    return entry.active;
+  }
+
+  static bool Probe(SubresourceFilter* filter,
+                    ReportingDisposition reporting_disposition) {
+    return !filter->AllowLoad(
+        KURL("http://sitescout.com"),
+        mojom::blink::RequestContextType::XML_HTTP_REQUEST,
+        reporting_disposition);
+  }
+
+ private:
+  static constexpr wtf_size_t kSize = 4;
+
+  struct Entry {
+    WeakPersistent<SubresourceFilter> filter;
+    bool active = false;
+  };
+
+  Entry entries_[kSize];
+  wtf_size_t next_entry_ = 0;
+};
+
+bool IsAdFilteringActive(SubresourceFilter* filter,
+                         ReportingDisposition reporting_disposition) {
+  if (!filter)
+    return false;
+  // Persistent handles must not outlive a worker heap, so workers probe on
+  // every request.
+  if (!IsMainThread())
+    return AdFilteringStateCache::Probe(filter, reporting_disposition);
+  DEFINE_STATIC_LOCAL(AdFilteringStateCache, cache, ());
+  return cache.IsActive(filter, reporting_disposition);
+}
+
+bool IsAllowedExactHost(const String& host) {
+  for (const char* allowed_host : kAllowedExactHosts) {
+    if (host == allowed_host)
+      return true;
+  }
+  return false;
+}
+
+bool MatchesBlockedUrlRule(const BuiltInBlockList& block_list,
+                           const String& url,
+                           const String& host) {
+  if (block_list.urls.ForEachMatch(url, [&host](uint32_t value) {
+        const BlockedUrlRule& rule = kBlockedUrlRules[value - 1];
+        return !rule.site || HostMatchesSite(host, rule.site);
+      })) {
+    return true;
+  }
+  const uint32_t parameters = block_list.url_parameters.Match(url);
+  if (!parameters)
+    return false;
+  for (uint32_t combination : kBlockedUrlParameterCombinations) {
+    if ((parameters & combination) == combination)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 absl::optional<ResourceRequestBlockedReason> BaseFetchContext::CanRequest(
     ResourceType type,
     const ResourceRequest& resource_request,
@@ -447,143 +1230,59 @@ BaseFetchContext::CanRequestInternal(
   if (ShouldBlockRequestByInspector(resource_request.Url()))
     return ResourceRequestBlockedReason::kInspector;
 
-  if (!(url.IsNull()) && !(url.Host().IsNull()) && !(url.Query().IsNull()) && !(url.GetPath()).IsNull() && !(url.GetString().IsNull()))
-  if (url.GetString().Contains("serve.popads.net/c") || url.GetPath().Contains("watch.xml") || url.Query().Contains("&vastref=") || (url.Host().Contains("flashx") && url.GetPath().length() == 45 && url.GetPath().Contains(".js")))
-      return ResourceRequestBlockedReason::kInspector;
-
-  if (!(url.IsNull()) && !(url.Host().IsNull()))
-  if (url.Host().Contains("dev-nano.com"))
-      return ResourceRequestBlockedReason::kInspector;
-
-  if (type == ResourceType::kScript)
-  {
-    if (!(url.IsNull()) && !(url.GetPath()).IsNull())
-    {
-    if (url.GetPath().Contains("cast_sender.js"))
-    {
-       return absl::nullopt;
-    }
-    if (url.GetPath().Contains("adblock.js"))
-    {
-       return absl::nullopt;
-    }
-    if (url.GetPath().Contains("ads.js"))
-    {
-       return absl::nullopt;
-    }
-    if (url.GetPath().Contains("trustguard.js"))
-    {
-       return absl::nullopt;
-    }
-    }
-  }
-  if (!(url.IsNull()) && !(url.GetPath()).IsNull())
-  if (url.GetPath().Contains("videojs.ads."))
-  {
-     return absl::nullopt;
+  // Built-in ad and tracker filtering. Each URL component is scanned once by
+  // the matchers of GetBuiltInBlockList(), see the rule tables above. The
+  // decision for the embedding page only depends on the document URL and is
+  // cached, see PageDecisionCache.
+  const BuiltInBlockList& block_list = GetBuiltInBlockList();
+  const String host = url.Host();
+  const String path = url.GetPath();
+  const String query = url.Query();
+  const PageDecision page = GetPageDecisionCache().Get(Url(), block_list);
+  const uint32_t host_categories = block_list.hosts.Match(host);
+  const uint32_t path_categories = block_list.paths.Match(path);
+  const bool has_all_url_components = !url.IsNull() && !host.IsNull() &&
+                                      !query.IsNull() && !path.IsNull() &&
+                                      !url.GetString().IsNull();
+
+  if (has_all_url_components &&
+      (url.GetString().Contains("serve.popads.net/c") ||
+       (path_categories & kPathPopunder) || query.Contains("&vastref=") ||
+       ((host_categories & kHostFlashx) && path.length() == 45 &&
+        path.Contains(".js")))) {
+    return ResourceRequestBlockedReason::kInspector;
   }
 
-  if (!(url.IsNull()) && !(url.Host().IsNull()))
-  if (url.Host() == "zoover.adnetasia.com"
-/*
-   || url.Host() == "zoover.adtrackers.net"
-   || url.Host() == "ox-d.adtrackers.net"
-   || url.Host() == "serve.adtrackers.net"
-   || url.Host() == "crunchyroll.adtrackers.net"
-*/
-   || url.Host().Contains(".bannertrack.net")
-   || url.Host().Contains(".adtrackers.net")
-   || url.Host().Contains(".adclixx.net")
-   || url.Host().Contains(".adnetasia.com")
-   || url.Host().Contains(".foxnetworks.com")
-   || url.Host().Contains(".clickability.com")
-   || url.Host().Contains("torrentz.")
-   || url.Host() == "partnerads.ysm.yahoo.com"
-   || url.Host() == "a.livesportmedia.eu"
-   || url.Host() == "promote.pair.com"
-   || url.Host() == "ad.mail.ru"
-   || url.Host() == "adn.ebay.com"
-   || url.Host() == "partnerads.ysm.yahoo.com"
-   || url.Host() == "advertising.aol.com"
-   || url.Host() == "www.gstatic.com"
-   || url.Host() == "juicyads.com"
-   || url.Host() == "ecosia.org"
-   || url.Host() == "www.ecosia.org"
-   || url.Host() == "cdn.ecosia.org"
-   || url.GetPath() == "/favicon.ico"
-   )
-  {
-     return absl::nullopt;
-  }
+  if (host_categories & kHostAlwaysBlocked)
+    return ResourceRequestBlockedReason::kInspector;
 
-  if (!(url.IsNull()) && !(url.Host().IsNull())) {
-  if (url.Host().Contains("imasdk.googleapis.com")) {
-     return absl::nullopt;
+  if (type == ResourceType::kScript &&
+      (path_categories & kPathAllowedForScripts)) {
+    return absl::nullopt;
   }
+  if (path_categories & kPathAllowed)
+    return absl::nullopt;
 
-  if (url.Host().Contains("translate.googleapis.com")) {
-     return absl::nullopt;
+  if (!url.IsNull() && !host.IsNull() &&
+      ((host_categories & kHostAllowed) || IsAllowedExactHost(host) ||
+       path == "/favicon.ico")) {
+    return absl::nullopt;
   }
 
-  if (url.Host().Contains("www.google-analytics.com")) {
-     return absl::nullopt;
-  }
+  if (type == ResourceType::kImage &&
+      (host_categories & kHostAllowedForImages)) {
+    return absl::nullopt;
   }
 
-  if (type == ResourceType::kImage)
-  {
-    if (!(url.IsNull()) && !(url.Host().IsNull())) {
-    if (url.Host().Contains(".cloudfront.net")
-     || url.Host().Contains("push"))
-     return absl::nullopt;
-    }
+  if (!url.IsNull() && page.has_host &&
+      (page.categories & kHostPageAllowlisted)) {
+    return absl::nullopt;
   }
 
-  if (!(url.IsNull()) && !(Url().Host().IsNull()) && (
-         Url().Host().Contains("google.")
-      || Url().Host().Contains("kiwibrowser.org")
-      || Url().Host().Contains("find.kiwi")
-      || Url().Host().Contains("ecosia.org")
-      || Url().Host().Contains("kiwisearchservices.com")
-      || Url().Host().Contains("kiwisearchservices.net")
-      || Url().Host().Contains("bing.com")
-      || Url().Host().Contains("bing.net")
-      || Url().Host().Contains("msn.com")
-      || Url().Host().Contains("lastpass.com")
-      || Url().Host().Contains("qwant.com")
-      || Url().Host().Contains("grammarly.com")
-      || Url().Host().Contains("yandex.ru")
-      || Url().Host().Contains(".amazon.")
-      || Url().Host().Contains("yandex.com")
-      || Url().Host().Contains("flashx")
-      || Url().Host().Contains("startpage.com")
-      || Url().Host().Contains(".ebay.")
-      || Url().Host().Contains("search.yahoo.")
-      || Url().Host().Contains("geo.yahoo.")
-      || Url().Host().Contains("doubleclick.net")))
-     return absl::nullopt;
-
-  if (!(url.IsNull()) && !(url.Host().IsNull()) && !(url.IsNull()) && !(Url().Host().IsNull()))
-  if (url.Host().Contains("google.") || url.Host().Contains("kiwibrowser.org") || url.Host().Contains("find.kiwi")
-   || Url().Host().Contains("kiwisearchservices.com")
-   || Url().Host().Contains("kiwisearchservices.net")
-   || url.Host().Contains("ecosia.org")
-   || url.Host().Contains("bing.com")
-   || url.Host().Contains("bing.net")
-   || url.Host().Contains("search.yahoo.")
-   || url.Host().Contains("geo.yahoo.")
-   || url.Host().Contains("msn.com")
-   || url.Host().Contains("qwant.com")
-   || url.Host().Contains("yandex.ru")
-   || url.Host().Contains(".amazon.")
-   || url.Host().Contains("yandex.com")
-   || url.Host().Contains("lastpass.com")
-   || url.Host().Contains("grammarly.com")
-   || url.Host().Contains("flashx")
-   || url.Host().Contains("startpage.com")
-   || url.Host().Contains(".ebay.")
-   )
-     return absl::nullopt;
+  if (!url.IsNull() && !host.IsNull() && page.has_host &&
+      (host_categories & kHostSearchAllowlisted)) {
+    return absl::nullopt;
+  }
 
   scoped_refptr<const SecurityOrigin> origin =
       resource_request.RequestorOrigin();
@@ -703,532 +1402,46 @@ BaseFetchContext::CanRequestInternal(
 
   // Let the client have the final say into whether or not the load should
   // proceed.
-  bool shouldBlockAds = true;
   // url = current element
   // Url() = host page
   // LOG(INFO) << "[Kiwi] Checking if shouldBlockAds on " << url << " - " << Url();
-  if (GetSubresourceFilter()) {
-      shouldBlockAds = !(GetSubresourceFilter()->AllowLoad(KURL("http://sitescout.com"), mojom::blink::RequestContextType::XML_HTTP_REQUEST,
-                                               reporting_disposition));
-  } else {
-      shouldBlockAds = false;
+  const bool shouldBlockAds =
+      IsAdFilteringActive(GetSubresourceFilter(), reporting_disposition);
+  if ((host_categories & kHostTracker) || query.Contains("&vastref=") ||
+      (path_categories & kPathBlocked)) {
+    return ResourceRequestBlockedReason::kInspector;
   }
-  if (url.Host().Contains("eviltracker.net") || url.Host().Contains("trackersimulator.org") || url.Host().Contains("do-not-tracker.org") || url.Host().Contains("ad.aloodo.com") || url.Host().Contains("extremetracking.com") || url.Host().Contains("extreme-dm.com") || url.Query().Contains("&vastref=") || url.GetPath().Contains("ads.xml"))
-      return ResourceRequestBlockedReason::kInspector;
   // for type see third_party/blink/renderer/platform/loader/fetch/resource.h
-  if (type >= ResourceType::kImage) {
-       if (!(url.IsNull()) && !(url.Host().IsNull()))
-       if (url.Host().Contains("cookieinformation.com")
-        || url.Host().Contains("cookie-script.com")
-        || url.Host().Contains("cookieassistant.com")
-        || url.Host().Contains("cookieconsent.com")
-        || url.Host().Contains("cookieconsent.silktide.com")
-        || url.Host().Contains("cookieq.com")
-        || url.Host().Contains("cookiereports.com")
-        || url.Host().Contains("consent.truste.com"))
-          return ResourceRequestBlockedReason::kInspector;
-  }
-  if (shouldBlockAds && type >= ResourceType::kImage) {
-    if (type == ResourceType::kScript || type == ResourceType::kImage)
-    {
-      if (!(url.IsNull()) && !(url.Host().IsNull()) && !(url.Query().IsNull()) && !(url.GetPath()).IsNull() && !(url.GetString().IsNull()))
-      if (url.Host().Contains("addthis")
-       || url.Host().Contains("chatango")
-       || url.Host().Contains("sharethis")
-       || url.Host().Contains("consensu.org")
-       || url.Host().Contains("cookieinformation.com")
-       || url.Host().Contains("consent.truste.com")
-       || url.Host().Contains("consent")
-       || url.Host().Contains("iubenda.com")
-       || url.Host().Contains("r42tag.com")
-       || url.Host().Contains("tm.tradetracker.net")
-       || url.Host().Contains("cookieq.com")
-       || url.Host().Contains("abtasty")
-       || url.Host().Contains("scorecardresearch")
-       || url.Host().Contains("cedexis")
-       || url.Host().Contains("api.amplitude.com")
-       || url.Host().Contains("krxd.net")
-       || url.Host().Contains("acpm.fr")
-       || url.Host().Contains(".plista.com")
-       || url.Host().Contains(".hotjar.com")
-       || url.Host().Contains("trustarc")
-       || url.Host().Contains("cxense")
-       || url.Host().Contains("chartbeat")
-       || url.Host().Contains("quantserve")
-       || url.Host().Contains("crwdcntrl")
-       || url.Host().Contains("gemius")
-       || url.Host().Contains("aticdn")
-       || url.Host().Contains("xiti")
-       || url.Host().Contains("ati-host")
-       || url.Host().Contains("tiqcdn")
-       || url.Host().Contains("floodprincipal.com")
-       || url.Host().Contains("newrelic")
-       || url.Host().Contains(".vntsm.com")
-       || url.Host().Contains("ownpage")
-       || url.Host().Contains("nuggad")
-       || url.Host().Contains("exelate")
-       || url.Host().Contains("goutee.top")
-       || url.Host().Contains("digidip.net")
-       || url.Host().Contains("tradelab.fr")
-       || url.Host().Contains("tr.snapchat.com")
-       || url.Host().Contains("exelator")
-       || url.Host().Contains("minute.ly")
-       || url.Host().Contains("ligatus")
-       || url.Host().Contains("hubvisor")
-       || url.Host().Contains("outbrain")
-       || url.Host().Contains("taboola")
-       || url.Host().Contains("mediavoice")
-       || url.Host().Contains("criteo")
-       || url.Host().Contains("demdex")
-       || url.Host().Contains("viglink")
-//       || url.Host().Contains("gigya.com")
-       || url.Host().Contains("segment.com")
-       || url.Host().Contains("tagcommander")
-       || url.Host().Contains("edigitalsurvey")
-       || url.Host().Contains("cookiematch")
-       || url.Host().Contains("seedtag")
-       || url.Host().Contains("estat.com")
-       || url.Host().Contains("zebestof.com")
-       || url.Host().Contains("kxcdn.com")
-       || url.Host().Contains("ccmbg.com")
-       || url.Host().Contains("push")
-       || url.Host().Contains("exosrv.com")
-       || url.Host().Contains("tubecorporate")
-       || url.Host().Contains("evidon")
-       || url.Host().Contains("optimizely.com")
-       || url.Host().Contains("edigitalsurvey.com")
-       || url.Host().Contains("condenastdigital.com")
-       || url.Host().Contains("bounceexchange.com")
-       || url.Host().Contains("zqtk.net")
-       || url.Host().Contains("yuyue")
-       || url.Host().Contains("ytdksb.com")
-       || url.Host().Contains("demdex.net")
-       || url.Host().Contains("adobedtm.com")
-       || url.Host().Contains("tvsquared.com")
-       || url.Host().Contains("metric")
-       || url.Host().Contains("lijit")
-       || url.Host().Contains("analytics")
-       || url.Host().Contains("adsco.re")
-       || url.Host().Contains("akstat")
-       || url.Host().Contains("onthe.io")
-       || url.Host().Contains("tns-counter.ru")
-       || url.Host().Contains("onesignal")
-       || url.Host().Contains("mgid")
-       || url.Host().Contains("adblockanalytics")
-       || url.Host().Contains("an.yandex.ru")
-       || url.Host().Contains("browsiprod")
-       || (url.Host().Contains(".cloudfront.net") && !url.GetPath().Contains("jwplayer") && !url.GetPath().Contains("app-min.js") && !url.GetPath().Contains("jquery"))
-       || url.GetPath().Contains("aabv121.php")
-       || url.GetPath().Contains("apu.php")
-       || url.GetPath().Contains("adlift")
-       || url.GetPath().Contains("smartbanner")
-       || url.GetPath().Contains("gampad/ads")
-       || url.GetPath().Contains("gpt/pubads")
-       || url.GetPath().Contains("notice.php")
-       || url.GetPath().Contains("gampad/ads")
-       || url.GetPath().Contains("interstitial.php")
-       || url.GetPath().Contains("1234.js")
-       || url.GetPath().Contains("ama.js")
-       || url.GetPath().Contains("/adServe/banners")
-       || (url.Host().Contains(".porn555.com") && url.GetPath().Contains("sw.js"))
-       || url.GetPath().Contains("afu.php")
-       || url.GetPath().Contains("speed.php")
-       || url.GetPath().Contains("nwm-dbh.min3.js")
-       || url.GetPath().Contains("prebid")
-       || url.GetPath().Contains("stats.php")
-       || url.GetPath().Contains("zcredirect")
-       || url.GetPath().Contains(".pop.js")
-       || (url.Host().length() == 14 && url.GetPath().length() == 45 && url.GetPath().Contains(".js"))
-// Generated by gen_base_fetch_context.php
-       || url.GetString().Contains("sleeknotestaticcontent.sleeknote.com") // newsletter
-       || url.GetString().Contains("js.driftt.com/include/") // newsletter
-       || url.GetString().Contains("assets.ubembed.com/universalscript/") // newsletter
-       || url.GetString().Contains("lightboxcdn.com/vendor/") // newsletter
-       || url.GetString().Contains("mailocator.net/_/") // newsletter
-       || url.GetString().Contains("cdn1.pdmntn.com") // newsletter
-       || url.GetString().Contains("static.mailerlite.com/js") // newsletter
-       || url.GetString().Contains("pmdstatic.net/bundle.php") // newsletter
-       || url.GetString().Contains("front.optimonk.com/public/") // newsletter
-       || url.GetString().Contains("/wp-content/plugins/newsletter-leads") // newsletter
-       || url.GetString().Contains("downloads.mailchimp.com/js/signup-forms") // newsletter
-       || url.GetString().Contains("conduit.mailchimpapp.com/js/stores") // newsletter
-       || url.GetString().Contains("a.optmnstr.com/app/js/") // newsletter
-       || url.GetString().Contains("getsocial.io/client/") // newsletter
-       || url.GetString().Contains("static.ctctcdn.com/js/signup-form-widget") // newsletter
-       || url.GetString().Contains("cdn.justuno.com/mwgt") // newsletter
-       || url.GetString().Contains("a.mailmunch.co/app/") // newsletter
-       || url.GetString().Contains("/newsletterPopup.js") // newsletter
-       || url.GetString().Contains("/pmgnews/overlay/newsletter") // newsletter
-       || url.GetString().Contains("dotmailer-surveys.com/scripts/survey.js") // newsletter
-       || url.GetString().Contains("yieldify.com/yieldify/code.js") // newsletter
-       || url.GetString().Contains("widget.privy.com/assets/widget.js") // newsletter
-       || url.GetString().Contains("sumo.b-cdn.net") // newsletter
-       || url.GetString().Contains("chimpstatic.com/mcjs-connected/js/users") // newsletter
-       || url.GetString().Contains("assets.pcrl.co/js/") // newsletter
-       || url.GetString().Contains("/wp-content/plugins/email-subscribers/widget/es-widget-page.js") // newsletter
-       || url.GetString().Contains("youlead.pl/Scripts/Dynamic.js") // newsletter
-       || url.GetString().Contains("m8.mailplus.nl/genericservice") // newsletter
-       || url.GetString().Contains("restapi.mailplus.nl/integrationservice") // newsletter
-       || url.GetString().Contains("snrcdn.net/sdk/") // newsletter
-       || url.GetString().Contains("static.dynamicyield.com/scripts/") // newsletter
-       || url.GetString().Contains("static.newsletter2go.com/utils.js") // newsletter
-       || url.GetString().Contains("/widget/ecNewsletterPopup/") // newsletter
-       || url.GetString().Contains("a.optmstr.com/app/js/") // newsletter
-       || url.GetString().Contains("api.autopilothq.com/anywhere/") // newsletter
-       || url.GetString().Contains("c.salecycle.com/osr/config") // newsletter
-       || url.GetString().Contains("/wp-content/plugins/thrive-leads/") // newsletter
-       || url.GetString().Contains("/wp-content/plugins/bloom/") // newsletter
-       || url.GetString().Contains("js.hsleadflows.net/leadflows.js") // newsletter
-       || url.GetString().Contains("/clientlib-newsletter.js") // newsletter
-       || url.GetString().Contains("c.lytics.io/static/pathfora") // newsletter
-       || url.GetString().Contains("email-signup-form-popup.js") // newsletter
-       || url.GetString().Contains("netpeak.cloud/source/js") // newsletter
-       || url.GetString().Contains("bunting.com/call") // newsletter
-       || url.GetString().Contains("cdn.connectif.cloud/cl1/client-script/") // newsletter
-       || url.GetString().Contains("/essb-optin-booster.js") // newsletter
-       || url.GetString().Contains("f.convertkit.com") // newsletter
-       || url.GetString().Contains("assets.bounceexchange.com/assets/smart-tags") // newsletter
-       || url.GetString().Contains("api.morningcatch.net") // newsletter
-       || url.GetString().Contains("shopify.privy.com/widget.js") // newsletter
-       || url.GetString().Contains("static.klaviyo.com/onsite/js/vendors~signupForms") // newsletter
-       || url.GetString().Contains("load.sumo.com") // newsletter
-       || url.GetString().Contains("cdn.listrakbi.com/scripts/script.js") // newsletter
-       || url.GetString().Contains("/wp-content/plugins/dreamgrow-scroll-triggered-box/") // newsletter
-       || url.GetString().Contains("d3bo67muzbfgtl.cloudfront.net/edrone") // newsletter
-       || url.GetString().Contains("/newsletter_modals.min.") // newsletter
-       || ((url.Host() == "m3medical.com" || url.Host().Contains(".m3medical.com")) && url.GetString().Contains("s.m3medical.com/popup/popup.production.js")) // newsletter
-       || ((url.Host() == "hessnatur.com" || url.Host().Contains(".hessnatur.com")) && url.GetString().Contains("ajax-open-layer?layerID=/nlsublay")) // newsletter
-       || ((url.Host() == "vontobel.com" || url.Host().Contains(".vontobel.com")) && url.GetString().Contains("NotificationDisclaimerControl.js")) // newsletter
-       || ((url.Host() == "wanderlust.co.uk" || url.Host().Contains(".wanderlust.co.uk")) && url.GetString().Contains("list-builder.js")) // newsletter
-       || ((url.Host() == "webmd.com" || url.Host().Contains(".webmd.com")) && url.GetString().Contains("/amd_modules/newsletter-hover")) // newsletter
-       || ((url.Host() == "toysrus.pt" || url.Host().Contains(".toysrus.pt")) && url.GetString().Contains("/politica-privacidade/lightbox")) // newsletter
-       || url.GetString().Contains("nebula-cdn.kampyle.com") // survey
-       || url.GetString().Contains("turbo.qualaroo.com/c.js") // survey
-       || url.GetString().Contains("scripts.psyma.com/layer_question.php") // survey
-       || url.GetString().Contains("w.usabilla.com") // survey
-       || url.GetString().Contains("static.hotjar.com/c/hotjar") // survey
-       || url.GetString().Contains("scripts.psyma.com/html/layer/json_question.php") // survey
-       || url.GetString().Contains("visualwebsiteoptimizer.com/va_survey") // survey
-       || url.GetString().Contains("gateway.answerscloud.com") // survey
-       || url.GetString().Contains("st.getsitecontrol.com/main/runtime/") // survey
-       || url.GetString().Contains("survey.g.doubleclick.net/survey") // survey
-       || url.GetString().Contains("/opiniac.js") // survey
-       || url.GetString().Contains("ssl.ceneo.pl/shops/") // survey
-       || url.GetString().Contains("cloud.netquest.sk/scripts/widget") // survey
-       || url.GetString().Contains("storage.googleapis.com/outfox/ocs/surveys/") // survey
-       || url.GetString().Contains("kameleoon.eu/kameleoon.js") // survey
-       || url.GetString().Contains("invitation.opinionbar.com/wit/popups") // survey
-       || url.GetString().Contains("neads.delivery/opinion-seed-embed.js") // survey
-       || url.GetString().Contains("collect.mopinion.com/assets/surveys/") // survey
-       || url.GetString().Contains("/runtimejs/dist/survey/js/survey.js") // survey
-       || url.GetString().Contains("surveygizmobeacon.s3.amazonaws.com/beaconconfigs/") // survey
-       || url.GetString().Contains("cpx.smind.hr/Log/LogData") // survey
-       || url.GetString().Contains("widget.surveymonkey.com/collect") // survey
-       || url.GetString().Contains("cdn.feedbackify.com/f.js") // survey
-       || url.GetString().Contains("invitation.opinionbar.com/popups") // survey
-       || url.GetString().Contains("/bundles/Scripts/OpinionLab.js") // survey
-       || url.GetString().Contains("survey.nuggad.net/c/layer-html") // survey
-       || url.GetString().Contains("ips-invite.iperceptions.com/invitations") // survey
-       || url.GetString().Contains("/oo_engine.min.js") // survey
-       || url.GetString().Contains("userzoom.com/feedback") // survey
-       || url.GetString().Contains("invite.leanlab.co/invite/invite.js") // survey
-       || url.GetString().Contains("userreport.com/newsquest/launcher.js") // survey
-       || url.GetString().Contains("siteintercept.qualtrics.com") // survey
-       || ((url.Host() == "lenovo.com" || url.Host().Contains(".lenovo.com")) && url.GetString().Contains("/vendor/opinionlab/")) // survey
-       || url.GetString().Contains("widget.manychat.com") // chat
-       || url.GetString().Contains("vivocha.com/a/") // chat
-       || url.GetString().Contains("altocloud-sdk.com/ac.js") // chat
-       || url.GetString().Contains("cdn.datahub.sempro.ai") // chat
-       || url.GetString().Contains("whatshelp.io/widget-send-button") // chat
-       || url.GetString().Contains("smartsuppchat.com/loader.js") // chat
-       || url.GetString().Contains("chat.wmy.io/widget") // chat
-       || url.GetString().Contains("crdx-feedback.appspot.com") // chat
-       || url.GetString().Contains("widget.whisbi.com") // chat
-       || url.GetString().Contains("mylivechat.com/chatinline") // chat
-       || url.GetString().Contains("static.zdassets.com/web_widget/") // chat
-       || url.GetString().Contains("cdn-widget.callpage.io") // chat
-       || url.GetString().Contains("/wp-content/plugins/makleraccess/assets/js/chat.") // chat
-       || url.GetString().Contains("widget.replain.cc/dist/client.js") // chat
-       || url.GetString().Contains("image.providesupport.com") // chat
-       || url.GetString().Contains("tinka.t-mobile.at") // chat
-       || url.GetString().Contains("userlike-cdn-widgets.s3-eu-west-1.amazonaws.com") // chat
-       || url.GetString().Contains("static.helloumi.com/umiwebcha") // chat
-       || url.GetString().Contains("embed.tawk.to") // chat
-       || url.GetString().Contains("widget.uservoice.com") // chat
-       || url.GetString().Contains("static.olark.com/jsclient") // chat
-       || url.GetString().Contains("xfbml.customerchat.js") // chat
-       || url.GetString().Contains("v2.zopim.com") // chat
-       || url.GetString().Contains("widget.intercom.io/widget") // chat
-       || url.GetString().Contains("/lz/server.php") // chat
-       || url.GetString().Contains("cdn.livechatinc.com/tracking.js") // chat
-       || url.GetString().Contains("widgets.trustedshops.com") // chat
-       || url.GetString().Contains("comm100.com/chatserver") // chat
-       || url.GetString().Contains("salesiq.zoho.com/widget") // chat
-       || url.GetString().Contains("www.czater.pl/assets/modules/chat/js/chat.js") // chat
-       || url.GetString().Contains("node.unifiedfactory.com") // chat
-       || url.GetString().Contains("cdn.kustomerapp.com/cw") // chat
-       || url.GetString().Contains("f01.inbenta.com") // chat
-       || url.GetString().Contains("static.classistatic.de/oplab/oo-v") // chat
-       || url.GetString().Contains("lc.iadvize.com/js/dist/livechat.js") // chat
-       || url.GetString().Contains("chatboxes.doyoudreamup.com/Prod/") // chat
-       || url.GetString().Contains("chat.kundo.se/chat/") // chat
-       || url.GetString().Contains(".vo.msecnd.net/ius-") // chat
-       || url.GetString().Contains("robincontentdesktop.blob.core.windows.net/external/robin/") // chat
-       || url.GetString().Contains("code.jivosite.com") // chat
-       || url.GetString().Contains("widgets.mango-office.ru") // chat
-       || url.GetString().Contains("firebaseapp.com/cfc/chat.js") // chat
-       || url.GetString().Contains("static-ssl.kundo.se/embed.js") // chat
-       || url.GetString().Contains("lc.iadvize.com/iadvize.js") // chat
-       || url.GetString().Contains("s.acquire.io") // chat
-       || url.GetString().Contains("assets.livecall.io/assets/livecall-widget.js") // chat
-       || url.GetString().Contains("/chatlio/chatlio.js") // chat
-       || url.GetString().Contains("app.purechat.com/VisitorWidget") // chat
-       || url.GetString().Contains("widget.customerly.io/widget") // chat
-       || url.GetString().Contains("limetalk.com/js/widget.js") // chat
-       || url.GetString().Contains("code.snapengage.com/js") // chat
-       || url.GetString().Contains("chatbot.api.nn-group.com") // chat
-       || url.GetString().Contains("wchat.freshchat.com") // chat
-       || url.GetString().Contains("lpcdn.lpsnmedia.net/le_re/") // chat
-       || url.GetString().Contains("static.userback.io/widget") // chat
-       || url.GetString().Contains("track.freecallinc.com/freecall.js") // chat
-       || url.GetString().Contains("addthis.com/static/layers") // chat
-       || url.GetString().Contains("asset.gomoxie.solutions/concierge/synnex/client/") // chat
-       || url.GetString().Contains("gateway.foresee.com/code/") // chat
-       || url.GetString().Contains("tbcdnwidgetsprod.azureedge.net/widget/") // chat
-       || url.GetString().Contains("/onlinechat/js_chat/chat_functions.js") // chat
-       || url.GetString().Contains("/onlinechat/chat_live_interface.php") // chat
-       || url.GetString().Contains("app.five9.com/consoles/SocialWidget/") // chat
-       || url.GetString().Contains("dragoman.com/livechat/") // chat
-       || url.GetString().Contains("js.usemessages.com/conversations-embed.js") // chat
-       || url.GetString().Contains(".tidiochat.com") // chat
-       || url.GetString().Contains("cdn.chatio-static.com/widget/") // chat
-       || url.GetString().Contains("smilee.io/assets/javascripts/cobrowse.js") // chat
-       || url.GetString().Contains("/javascript/livechat.js") // chat
-       || url.GetString().Contains("vmss.boldchat.com/aid/") // chat
-       || url.GetString().Contains("cdn.elev.io/sdk/bootloader/v4/elevio-bootloader.js") // chat
-       || url.GetString().Contains("service.force.com/embeddedservice/") // chat
-       || url.GetString().Contains("my.salesforce.com/embeddedservice/") // chat
-       || url.GetString().Contains("sidecar.gitter.im/dist/") // chat
-       || url.GetString().Contains("client.crisp.chat") // chat
-       || url.GetString().Contains("snapengage.com/cdn/js/") // chat
-       || url.GetString().Contains("static.goqubit.com/smartserve") // chat
-       || url.GetString().Contains("/jquery.livehelp.js") // chat
-       || url.GetString().Contains("config.gorgias.io") // chat
-       || url.GetString().Contains("chatserver.comm100.com") // chat
-       || url.GetString().Contains("sb.monetate.net/img/") // chat
-       || url.GetString().Contains("realperson.de/system/scripts/loadchatmodul.js") // chat
-       || url.GetString().Contains("beacon-v2.helpscout.net") // chat
-       || url.GetString().Contains("wm-livechat-prod-dot-watermelonmessenger.appspot.com") // chat
-       || url.GetString().Contains("widget.destygo.com/destygo-webchat.js") // chat
-       || url.GetString().Contains("assets.freshservice.com/widget") // chat
-       || url.GetString().Contains("calendly.com/assets/external/widget.js") // chat
-       || url.GetString().Contains("/uisdk/botchat.js") // chat
-       || url.GetString().Contains("chat-widget.thulium.com/app/chat-loader.js") // chat
-       || url.GetString().Contains("assets.kayako.com/messenger") // chat
-       || url.GetString().Contains("static.landbot.io/landbot-widget") // chat
-       || url.GetString().Contains("projects.elitechnology.com/jsprojects/pggm/client") // chat
-       || url.GetString().Contains("humany.net/default/embed.js") // chat
-       || url.GetString().Contains("/js/common/tokywoky-") // chat
-       || url.GetString().Contains("widget.dixa.io/assets/scripts") // chat
-       || url.GetString().Contains("support.qualityunit.com/scripts/button.php") // chat
-       || url.GetString().Contains("/kapturesupport.nojquery.min.js") // chat
-       || url.GetString().Contains("/chat-widget/clientLibs.min.") // chat
-       || url.GetString().Contains("call.chatra.io/chatra.js") // chat
-       || url.GetString().Contains("api.asksid.ai/akzo-webchat") // chat
-       || url.GetString().Contains("/js/chatPanel.js") // chat
-       || url.GetString().Contains("videocall.te-ex.ru/js/richcall.widget.js") // chat
-       || url.GetString().Contains("chatbot.inbenta.com") // chat
-       || url.GetString().Contains("wm-livechat-2-prod-dot-watermelonmessenger.appspot.com") // chat
-       || url.GetString().Contains("static.triptease.io/client-integrations") // chat
-       || url.GetString().Contains("freshdesk.com/widget/freshwidget.js") // chat
-       || url.GetString().Contains("/livehelperchat-master/lhc_web/") // chat
-       || url.GetString().Contains("verbox.ru/support/support.js") // chat
-       || url.GetString().Contains("storage.googleapis.com/livezhat") // chat
-       || url.GetString().Contains("subiz.com/static/js/app.js") // chat
-       || url.GetString().Contains("w.usabilla.com") // chat
-       || url.GetString().Contains("cdn.rlets.com/capture_configs") // chat
-       || url.GetString().Contains("reachlocallivechat.com/scripts/dyns.js") // chat
-       || url.GetString().Contains("webchat.big-box.net/chat") // chat
-       || url.GetString().Contains("cdn.gubagoo.io/toolbars") // chat
-       || url.GetString().Contains("userreport.com/userreport.js") // chat
-       || url.GetString().Contains("widget.alphablues.com/widget/alphachat.js") // chat
-       || url.GetString().Contains("inbenta.com/assets/js/inbenta") // chat
-       || url.GetString().Contains("sdk.inbenta.io/chatbot") // chat
-       || url.GetString().Contains("liveagent.se/scripts/track.js") // chat
-       || url.GetString().Contains("/NetworkContacts.AskMeSEM.WebChat/") // chat
-       || url.GetString().Contains("googleapis.com/snapengage-eu/js") // chat
-       || url.GetString().Contains("messenger.ngageics.com") // chat
-       || url.GetString().Contains("justanswer.com/js/ja-gadget-virtual-assistant") // chat
-       || url.GetString().Contains("par.salesforceliveagent.com") // chat
-       || ((url.Host() == "plaisio.gr" || url.Host().Contains(".plaisio.gr")) && url.GetString().Contains("scripts/pls.chat")) // chat
-       || ((url.Host() == "sainsburysbank.co.uk" || url.Host().Contains(".sainsburysbank.co.uk")) && url.GetString().Contains("sa_emb/va.min.js")) // chat
-       || ((url.Host() == "vocabulix.com" || url.Host().Contains(".vocabulix.com")) && url.GetString().Contains("/contact-us.js")) // chat
-       || ((url.Host() == "ibm.com" || url.Host().Contains(".ibm.com")) && url.GetString().Contains("/cm-app/latest/cm-app.min.js")) // chat
-       || ((url.Host() == "ibm.com" || url.Host().Contains(".ibm.com")) && url.GetString().Contains("/common/digitaladvisor/cm-app/")) // chat
-       || ((url.Host() == "redmineup.com" || url.Host().Contains(".redmineup.com")) && url.GetString().Contains("/helpdesk_widget/widget.js")) // chat
-       || ((url.Host() == "ter.sncf.com" || url.Host().Contains(".ter.sncf.com")) && url.GetString().Contains("snap.snapcall.io")) // chat
-       || ((url.Host() == "website-bereinigung.de" || url.Host().Contains(".website-bereinigung.de")) && url.GetString().Contains("chat.website-bereinigung.de/resource.php")) // chat
-       || ((url.Host() == "muziker.nl" || url.Host().Contains(".muziker.nl")) && url.GetString().Contains("support.muziker.com/scripts/track.js")) // chat
-       || ((url.Host() == "digistar.vn" || url.Host().Contains(".digistar.vn")) && url.GetString().Contains("/crm/site_button")) // chat
-       || ((url.Host() == "analog.com" || url.Host().Contains(".analog.com")) && url.GetString().Contains("custom-content-collection")) // chat
-       || url.GetString().Contains("ssl.heureka.cz/direct/i/gjs.php") // rating
-       || url.GetString().Contains("opineo.pl/shop/slider.js") // rating
-       || url.GetString().Contains("https://static.arukereso.hu/widget/presenter.js") // rating
-       || url.GetString().Contains("cpx.smind.si/Log/") // rating
-       || url.GetString().Contains("widget.trustpilot.com") // rating
-       || url.GetString().Contains("dash.reviews.co.uk/widget/float.js") // rating
-       || url.GetString().Contains("dashboard.webwinkelkeur.nl/webshops/sidebar.js") // rating
-       || url.GetString().Contains("staticw2.yotpo.com") // rating
-       || url.GetString().Contains("cdn.trustami.com/widgetapi") // rating
-       || url.GetString().Contains("cdn.ywxi.net/js/") // rating
-       || url.GetString().Contains("monaviscompte.fr/widget") // rating
-       || url.GetString().Contains("nsg.symantec.com/Web/Seal/") // rating
-       || url.GetString().Contains("widget.reviews.co.uk/rich-snippet-reviews-widgets/dist.js") // rating
-       || url.GetString().Contains("static.pazaruvaj.com/widget") // rating
-       || url.GetString().Contains("avis-verifies.com/js/widget") // rating
-       || url.GetString().Contains("cdn.p-n.io/pushly") // push
-       || url.GetString().Contains("app3.emlgrid.com/static/sm.js") // push
-       || url.GetString().Contains("webpush-desktop.chunk.js") // push
-       || url.GetString().Contains("push4site.com/Static/Script/") // push
-       || url.GetString().Contains("cdn.ghostmonitor.com") // push
-       || url.GetString().Contains("notify.hindustantimes.com") // push
-       || url.GetString().Contains("webpush.interia.pl") // push
-       || url.GetString().Contains("cdn.izooto.com/scripts/") // push
-       || url.GetString().Contains("js.pusher.com/") // push
-       || url.GetString().Contains("push-ad.com/integration.php") // push
-       || url.GetString().Contains("cdn.pushassist.com/account/assets/") // push
-       || url.GetString().Contains("gadgets.ndtv.com/static/desktop/js/notification_popup-min.js") // push
-       || url.GetString().Contains("pusherism.com") // push
-       || url.GetString().Contains("pushnest.com") // push
-       || url.GetString().Contains("getpushmonkey.com/sdk/config") // push
-       || url.GetString().Contains("cdn.onesignal.com/sdks/OneSignalSDK.js") // push
-       || url.GetString().Contains("pushpushgo.com/js") // push
-       || url.GetString().Contains("cdn.sendpulse.com") // push
-       || url.GetString().Contains("salesmanago.pl/static/sm.js") // push
-       || url.GetString().Contains("cdn.pushcrew.com") // push
-       || url.GetString().Contains("/streamlined-push-plugin.production.min.js") // push
-       || url.GetString().Contains("app.push-ad.com") // push
-       || url.GetString().Contains("/pushnotification/service-worker-script.js") // push
-       || url.GetString().Contains("/sp-push-worker.js") // push
-       || url.GetString().Contains("95p5qep4aq.com") // push
-       || url.GetString().Contains("snrcdn.net/sdk/") // push
-       || url.GetString().Contains("via.batch.com") // push
-       || url.GetString().Contains("wonderpush.com/sdk/") // push
-       || url.GetString().Contains("clientcdn.pushengage.com") // push
-       || url.GetString().Contains("web-sdk.urbanairship.com/notify/") // push
-       || url.GetString().Contains("api.sociaplus.com") // push
-       || url.GetString().Contains("/plugins/tmx-push/") // push
-       || url.GetString().Contains("/firebase-messaging.js") // push
-       || url.GetString().Contains("pushno.com") // push
-       || url.GetString().Contains("pushwhy.com") // push
-       || url.GetString().Contains("pushame.com") // push
-       || url.GetString().Contains("voirfilms.ws/sw.js") // push
-       || url.GetString().Contains("siteswithcontent.com/js/push") // push
-       || url.GetString().Contains("cdn.moengage.com/webpush") // push
-       || url.GetString().Contains("brandflow.net/static/general/push-init-code.js") // push
-       || url.GetString().Contains("static.cleverpush.com/channel/loader") // push
-       || url.GetString().Contains("static.getback.ch/clients") // push
-       || url.GetString().Contains("/PushNotifications.") // push
-       || url.GetString().Contains("cdn.pushowl.com/sdks") // push
-       || url.GetString().Contains("accengage.net/pushweb/") // push
-       || url.GetString().Contains("cdn.foxpush.net/sdk/foxpush_SDK") // push
-       || url.GetString().Contains("js.appboycdn.com/web-sdk/") // push
-       || url.GetString().Contains("cdn.taboola.com/libtrc/tmg-network/loader.js") // push
-       || url.GetString().Contains("/js/push_subscription.js") // push
-       || url.GetString().Contains("pushwoosh.com/webpush") // push
-       || url.GetString().Contains("push_service-worker.js") // push
-       || url.GetString().Contains("0_ghpush_client.js") // push
-       || url.GetString().Contains("pastoupt.com/ntfc.php") // push
-       || url.GetString().Contains("pushsar.com/ntfc.php") // push
-       || url.GetString().Contains("sdk.jeeng.com") // push
-       || url.GetString().Contains("gstatic.com/firebasejs/") // push
-       || url.GetString().Contains("d3bo67muzbfgtl.cloudfront.net/edrone") // push
-       || ((url.Host() == "pinterest.com" || url.Host().Contains(".pinterest.com")) && url.GetString().Contains("/sw.js")) // push
-       || ((url.Host() == "spartanien.de" || url.Host().Contains(".spartanien.de")) && url.GetString().Contains("/public/spartanien/js/sw_handler")) // push
-       || ((url.Host() == "rt.com" || url.Host().Contains(".rt.com")) && url.GetString().Contains("/pushes/notification.js")) // push
-       || ((url.Host() == "mitula.pt" || url.Host().Contains(".mitula.pt")) && url.GetString().Contains("/js/subscriber")) // push
-       || ((url.Host() == "alibaba.com" || url.Host().Contains(".alibaba.com")) && url.GetString().Contains("/firebase.js")) // push
-       || ((url.Host() == "1337x.is" || url.Host().Contains(".1337x.is")) && url.GetString().Contains("/sw.js")) // push
-       || ((url.Host() == "1337x.to" || url.Host().Contains(".1337x.to")) && url.GetString().Contains("/sw.js")) // push
-       || ((url.Host() == "ndtv.com" || url.Host().Contains(".ndtv.com")) && url.GetString().Contains("push-main.js")) // push
-       || ((url.Host() == "hardwarezone.com.sg" || url.Host().Contains(".hardwarezone.com.sg")) && url.GetString().Contains("/js/adNotice.js")) // push
-       || ((url.Host() == "tut.by" || url.Host().Contains(".tut.by")) && url.GetString().Contains("/push/")) // push
-       || ((url.Host() == "azoresgetaways.com" || url.Host().Contains(".azoresgetaways.com")) && url.GetString().Contains("/firebase.min.js")) // push
-       || ((url.Host() == "hoerbuch.us" || url.Host().Contains(".hoerbuch.us")) && url.GetString().Contains("client-.js")) // push
-       || url.GetString().Contains("/geoPosition.min.js") // location
-       || url.GetString().Contains("stat.profession.hu/static/js/geoPosition.js") // location
-       || url.GetString().Contains("nero.live/tags/mwa.min.js") // location
-       || url.GetString().Contains("z.moatads.com") // location
-       || url.GetString().Contains("wonderpush.com/sdk/") // location
-       || url.GetString().Contains("abs.proxistore.com") // location
-       || url.GetString().Contains("cdn.hexago.io/tag/js/hexago.min.js") // location
-       || url.GetString().Contains("/typo3temp/compressor/geoloc-") // location
-       || url.GetString().Contains("/wp-content/plugins/strathcom-personalization/") // location
-       || url.GetString().Contains("/web/modules/gps_location.js") // location
-       || url.GetString().Contains("/lib/geoPosition/geoPosition.js") // location
-       || ((url.Host() == "byggmax.no" || url.Host().Contains(".byggmax.no")) && url.GetString().Contains("/Byggmax_Geolocation/js/closest-store-selector.js")) // location
-       || ((url.Host() == "dhl.de" || url.Host().Contains(".dhl.de")) && url.GetString().Contains("/clientlibs/foundation/personalization/")) // location
-       || ((url.Host() == "sat24.com" || url.Host().Contains(".sat24.com")) && url.GetString().Contains("/sat24mylocation.")) // location
-       || ((url.Host() == "mcdonalds.ru" || url.Host().Contains(".mcdonalds.ru")) && url.GetString().Contains("api-maps.yandex.ru")) // location
-       || ((url.Host() == "magniflex.cz" || url.Host().Contains(".magniflex.cz")) && url.GetString().Contains("nearest-place.js")) // location
-       || ((url.Host() == "intesasanpaolo.com" || url.Host().Contains(".intesasanpaolo.com")) && url.GetString().Contains("nearestFilialeService.js")) // location
-       || ((url.Host() == "reseau-canope.fr" || url.Host().Contains(".reseau-canope.fr")) && url.GetString().Contains("/atelier.min.js")) // location
-       || url.GetString().Contains("advinapps.com/ads-async.js") // app
-       || url.GetString().Contains("cdn.branch.io/branch-latest.min.js") // app
-       || url.GetString().Contains("browser-update.org/update.show.min.js") // app
-       || url.GetString().Contains("js.convertflow.co/production/websites") // app
-       || ((url.Host() == "mosalingua.com" || url.Host().Contains(".mosalingua.com")) && url.GetString().Contains("/jquery.bxSlider.min.js")) // app
-       || ((url.Host() == "vontobel.com" || url.Host().Contains(".vontobel.com")) && url.GetString().Contains("NotificationDisclaimerControl.js")) // app
-       || ((url.Host() == "designtaxi.com" || url.Host().Contains(".designtaxi.com")) && url.GetString().Contains("fancy-bar.js")) // app
-       || url.GetString().Contains("translate.googleapis.com/element/TE_") // translation
-       || url.GetString().Contains("/wp-content/plugins/google-language-translator/") // translation
-       || url.GetString().Contains("/back-to-top.js") // top
-       || url.GetString().Contains("/wp-content/plugins/hms-navigationarrows/") // top
-       || url.GetString().Contains("/scroll-to-top.min.js") // top
-       || url.GetString().Contains("/catchresponsive-scrollup.min.js") // top
-       || url.GetString().Contains("/wp-content/plugins/jcwp-scroll-to-top/") // top
-       || url.GetString().Contains("apps.veedio.it/js/videobox") // video
-       || url.GetString().Contains("/responsive-player/video-feature-sticky.js") // video
-       || url.GetString().Contains("s-pt.ppstatic.pl/p/js/regionalne/plywajace_wideo.js") // video
-       || url.GetString().Contains("/js/compiled/atoms/article/sticky-video.js") // video
-       || url.GetString().Contains("sdk.digitalbees.it/jssdk.js") // video
-       || ((url.Host() == "dailymail.co.uk" || url.Host().Contains(".dailymail.co.uk")) && url.GetString().Contains("mol-adverts.js")) // video
-       || url.GetString().Contains("w.usabilla.com") // signup
-       || url.GetString().Contains("cdn.tinypass.com/api/tinypass.min.js") // subscribe
-       || url.GetString().Contains("tag.rightmessage.com") // subscribe
-       || (url.GetString().Contains("&sw=") && url.GetString().Contains("&sh=") && url.GetString().Contains("&sah=") && url.GetString().Contains("&ww=") && url.GetString().Contains("&wh=") && url.GetString().Contains("&pl="))
-       || url.GetString().Contains("&zone_id=")
-       || url.GetString().Contains("/zone?pub=")
-       || url.GetString().Contains(".php?OAID=")
-       || url.GetString().Contains("/jump/next.php?r=")
-       || url.GetString().Contains("improving.duckduckgo.com")
-       || (url.GetString().Contains("?key=") && url.GetString().Contains("&uuid="))
-       || (url.GetString().Contains("&id=") && url.GetString().Contains("&lm=") && url.GetString().Contains("&ts=") && url.GetString().Contains("&dn="))
-       || (url.GetString().Contains("&id=") && url.GetString().Contains("&dn=") && url.GetString().Contains("&c=") && url.GetString().Contains("&r="))
-       || ((url.Host() == "latimes.com" || url.Host().Contains(".latimes.com")) && url.GetString().Contains("tribdss.com/meter/assets/latarc-reaction")) // subscribe
-      )
-      {
-        return ResourceRequestBlockedReason::kInspector;
-      }
+  if (type >= ResourceType::kImage && (host_categories & kHostCookieConsent))
+    return ResourceRequestBlockedReason::kInspector;
+  if (shouldBlockAds && type >= ResourceType::kImage &&
+      (type == ResourceType::kScript || type == ResourceType::kImage) &&
+      has_all_url_components) {
+    if ((host_categories & kHostAd) ||
+        ((host_categories & kHostCloudFront) &&
+         !(path_categories & kPathAllowedOnCloudFront)) ||
+        (path_categories & kPathAd) ||
+        ((host_categories & kHostPorn555) &&
+         (path_categories & kPathServiceWorker)) ||
+        (host.length() == 14 && path.length() == 45 && path.Contains(".js")) ||
+        MatchesBlockedUrlRule(block_list, url.GetString(), host)) {
+      return ResourceRequestBlockedReason::kInspector;
     }
   }
   if (GetSubresourceFilter()) {
     if (!GetSubresourceFilter()->AllowLoad(url, request_context,
                                            reporting_disposition)) {
-       if (!Url().IsNull() && !Url().Host().IsNull() && (Url().Host().Contains("bild.de")
-           || Url().Host().Contains("postimees.ee")
-           || Url().Host().Contains("grammarly.com")
-           || Url().Host().Contains("espn.com")))
-          return absl::nullopt;
-      if (!(url.IsNull()) && !(url.Host().IsNull()) && !(url.Query().IsNull()) && !(url.GetPath()).IsNull() && !(url.GetString().IsNull())) {
-      if (url.Host().Contains("api.ero-advertising.com") && url.GetPath().Contains("get.php"))
-      {
-          return absl::nullopt;
+      if (page.has_host &&
+          (page.categories & kHostSubresourceFilterExemptPage)) {
+        return absl::nullopt;
       }
-      if (url.Host().Contains("xvideos-cdn.com"))
-      {
+      if (has_all_url_components) {
+        if ((host_categories & kHostEroAdvertising) &&
+            (path_categories & kPathEroAdvertising)) {
+          return absl::nullopt;
+        }
+        if (host_categories & kHostSubresourceFilterExempt)
           return absl::nullopt;
-      }
       }
       return ResourceRequestBlockedReason::kSubresourceFilter;
     }
@@ -0,0 +1,70 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_BUILT_IN_BLOCK_LIST_H_
+#define THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_BUILT_IN_BLOCK_LIST_H_
+
+#include <stdint.h>
+
+#include "third_party/blink/renderer/core/loader/multi_substring_matcher.h"
+
+namespace blink {
+
+// Categories reported by the built-in block list for a host. One host can be
+// in several categories, e.g. "grammarly.com" is both an allowlisted page and
+// exempt from the subresource filter.
+enum HostCategory : uint32_t {
+  kHostAlwaysBlocked = 1 << 0,
+  kHostFlashx = 1 << 1,
+  // Never filtered, whatever the embedding page.
+  kHostAllowed = 1 << 2,
+  kHostAllowedForImages = 1 << 3,
+  // Pages on which nothing is filtered.
+  kHostPageAllowlisted = 1 << 4,
+  // Resources that are never filtered, whatever the embedding page.
+  kHostSearchAllowlisted = 1 << 5,
+  kHostTracker = 1 << 6,
+  kHostCookieConsent = 1 << 7,
+  // Blocked while the subresource filter is active.
+  kHostAd = 1 << 8,
+  kHostCloudFront = 1 << 9,
+  kHostPorn555 = 1 << 10,
+  // Pages on which subresource filter decisions are overridden.
+  kHostSubresourceFilterExemptPage = 1 << 11,
+  kHostSubresourceFilterExempt = 1 << 12,
+  kHostEroAdvertising = 1 << 13,
+};
+
+enum PathCategory : uint32_t {
+  kPathAllowedForScripts = 1 << 0,
+  kPathAllowed = 1 << 1,
+  kPathPopunder = 1 << 2,
+  kPathBlocked = 1 << 3,
+  kPathAd = 1 << 4,
+  kPathAllowedOnCloudFront = 1 << 5,
+  kPathServiceWorker = 1 << 6,
+  kPathEroAdvertising = 1 << 7,
+};
+
+// The rule tables of the fetch blocker (see base_fetch_context.cc) compiled
+// into one automaton per URL component, so that each component of a URL is
+// scanned once whatever the number of rules. |hosts| and |paths| report the
+// categories above, |url_parameters| and |urls| are private to the fetch
+// blocker. Built on first use and shared by all threads.
+struct BuiltInBlockList {
+  BuiltInBlockList();
+  BuiltInBlockList(const BuiltInBlockList&) = delete;
+  BuiltInBlockList& operator=(const BuiltInBlockList&) = delete;
+
+  MultiSubstringMatcher hosts;
+  MultiSubstringMatcher paths;
+  MultiSubstringMatcher url_parameters;
+  MultiSubstringMatcher urls;
+};
+
+const BuiltInBlockList& GetBuiltInBlockList();
+
+}  // namespace blink
+
+#endif  // THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_BUILT_IN_BLOCK_LIST_H_
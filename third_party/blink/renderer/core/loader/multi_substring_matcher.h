@@ -0,0 +1,188 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_MULTI_SUBSTRING_MATCHER_H_
+#define THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_MULTI_SUBSTRING_MATCHER_H_
+
+#include "base/check.h"
+#include "third_party/blink/renderer/platform/wtf/allocator/allocator.h"
+#include "third_party/blink/renderer/platform/wtf/deque.h"
+#include "third_party/blink/renderer/platform/wtf/text/string_view.h"
+#include "third_party/blink/renderer/platform/wtf/vector.h"
+
+namespace blink {
+
+// Aho-Corasick automaton over a fixed set of literal, case-sensitive
+// substrings. Every pattern carries a caller-defined 32-bit value (usually a
+// bitmask of rule categories). All patterns are added up front and Build() is
+// called once; after that the matcher is immutable and can be shared between
+// the main thread and workers. Matching walks the text exactly once, whatever
+// the number of patterns, which replaces long chains of String::Contains().
+class MultiSubstringMatcher {
+  USING_FAST_MALLOC(MultiSubstringMatcher);
+
+ public:
+  MultiSubstringMatcher() { nodes_.emplace_back(); }
+  MultiSubstringMatcher(const MultiSubstringMatcher&) = delete;
+  MultiSubstringMatcher& operator=(const MultiSubstringMatcher&) = delete;
+
+  void AddPattern(const char* pattern, uint32_t value) {
+    DCHECK(!built_);
+    DCHECK(pattern && *pattern);
+    DCHECK(value);
+    wtf_size_t node = 0;
+    for (const char* c = pattern; *c; ++c) {
+      const LChar ch = static_cast<LChar>(*c);
+      wtf_size_t next = Child(node, ch);
+      if (next == kNoNode) {
+        next = nodes_.size();
+        nodes_[node].edges.push_back(Edge{ch, next});
+        nodes_.emplace_back();
+      }
+      node = next;
+    }
+    nodes_[node].values.push_back(value);
+    nodes_[node].mask |= value;
+  }
+
+  // Computes failure and output links. Must be called once, after the last
+  // AddPattern() and before the first match.
+  void Build() {
+    DCHECK(!built_);
+    Deque<wtf_size_t> queue;
+    for (const Edge& edge : nodes_[0].edges) {
+      nodes_[edge.target].fail = 0;
+      queue.push_back(edge.target);
+    }
+    while (!queue.empty()) {
+      const wtf_size_t node = queue.TakeFirst();
+      for (const Edge& edge : nodes_[node].edges) {
+        wtf_size_t fail = nodes_[node].fail;
+        wtf_size_t next;
+        while ((next = Child(fail, edge.ch)) == kNoNode && fail != 0)
+          fail = nodes_[fail].fail;
+        Node& child = nodes_[edge.target];
+        child.fail = next == kNoNode ? 0 : next;
+        const Node& fail_node = nodes_[child.fail];
+        child.mask |= fail_node.mask;
+        child.output =
+            fail_node.values.IsEmpty() ? fail_node.output : child.fail;
+        queue.push_back(edge.target);
+      }
+    }
+    built_ = true;
+  }
+
+  // Returns the OR of the values of every pattern occurring in |text|.
+  uint32_t Match(const StringView& text) const {
+    uint32_t result = 0;
+    Walk(text, [&result](const Node& node) {
+      result |= node.mask;
+      return false;
+    });
+    return result;
+  }
+
+  // Returns true if any pattern occurring in |text| has a value sharing a bit
+  // with |mask|. Stops at the first such occurrence.
+  bool MatchesAny(const StringView& text, uint32_t mask) const {
+    return Walk(text,
+                [mask](const Node& node) { return (node.mask & mask) != 0; });
+  }
+
+  // Calls |callback(value)| for every pattern occurrence in |text| until it
+  // returns true. Returns whether the callback stopped the scan.
+  template <typename Callback>
+  bool ForEachMatch(const StringView& text, Callback callback) const {
+    return Walk(text, [this, &callback](const Node& node) {
+      if (!node.mask)
+        return false;
+      for (const Node* out = &node;;) {
+        for (uint32_t value : out->values) {
+          if (callback(value))
+            return true;
+        }
+        if (out->output == kNoNode)
+          return false;
+        out = &nodes_[out->output];
+      }
+    });
+  }
+
+ private:
+  static constexpr wtf_size_t kNoNode = static_cast<wtf_size_t>(-1);
+
+  struct Edge {
+    LChar ch;
+    wtf_size_t target;
+  };
+
+  struct Node {
+    Vector<Edge> edges;
+    // Values of the patterns ending exactly at this node.
+    Vector<uint32_t> values;
+    // OR of |values| and of the values reachable through failure links.
+    uint32_t mask = 0;
+    wtf_size_t fail = 0;
+    // Nearest node on the failure chain that ends a pattern.
+    wtf_size_t output = kNoNode;
+  };
+
+  wtf_size_t Child(wtf_size_t node, LChar ch) const {
+    for (const Edge& edge : nodes_[node].edges) {
+      if (edge.ch == ch)
+        return edge.target;
+    }
+    return kNoNode;
+  }
+
+  static bool ToLChar(LChar c, LChar* out) {
+    *out = c;
+    return true;
+  }
+
+  static bool ToLChar(UChar c, LChar* out) {
+    if (c > 0xFF)
+      return false;
+    *out = static_cast<LChar>(c);
+    return true;
+  }
+
+  template <typename CharType, typename Visitor>
+  bool WalkChars(const CharType* chars, wtf_size_t length,
+                 const Visitor& visitor) const {
+    wtf_size_t node = 0;
+    for (wtf_size_t i = 0; i < length; ++i) {
+      LChar ch;
+      if (!ToLChar(chars[i], &ch)) {
+        node = 0;
+        continue;
+      }
+      wtf_size_t next;
+      while ((next = Child(node, ch)) == kNoNode && node != 0)
+        node = nodes_[node].fail;
+      node = next == kNoNode ? 0 : next;
+      if (nodes_[node].mask && visitor(nodes_[node]))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename Visitor>
+  bool Walk(const StringView& text, const Visitor& visitor) const {
+    DCHECK(built_);
+    if (text.IsNull() || text.IsEmpty())
+      return false;
+    if (text.Is8Bit())
+      return WalkChars(text.Characters8(), text.length(), visitor);
+    return WalkChars(text.Characters16(), text.length(), visitor);
+  }
+
+  Vector<Node> nodes_;
+  bool built_ = false;
+};
+
+}  // namespace blink
+
+#endif  // THIRD_PARTY_BLINK_RENDERER_CORE_LOADER_MULTI_SUBSTRING_MATCHER_H_
@@ -28,6 +28,7 @@
 
 #include "base/feature_list.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/time/time.h"
 #include "services/metrics/public/cpp/ukm_builders.h"
 #include "third_party/blink/public/common/dom_storage/session_storage_namespace_id.h"
 #include "third_party/blink/public/common/features.h"
@@ -47,15 +48,18 @@
 #include "third_party/blink/renderer/core/html/conversion_measurement_parsing.h"
 #include "third_party/blink/renderer/core/inspector/console_message.h"
 #include "third_party/blink/renderer/core/loader/frame_load_request.h"
+#include "third_party/blink/renderer/core/loader/multi_substring_matcher.h"
 #include "third_party/blink/renderer/core/page/chrome_client.h"
 #include "third_party/blink/renderer/core/page/page.h"
 #include "third_party/blink/renderer/core/probe/core_probes.h"
 #include "third_party/blink/renderer/platform/heap/heap.h"
+#include "third_party/blink/renderer/platform/heap/persistent.h"
 #include "third_party/blink/renderer/platform/loader/fetch/resource_request.h"
 #include "third_party/blink/renderer/platform/weborigin/kurl.h"
 #include "third_party/blink/renderer/platform/wtf/text/number_parsing_options.h"
 #include "third_party/blink/renderer/platform/wtf/text/string_to_number.h"
 #include "third_party/blink/renderer/platform/wtf/text/string_view.h"
+#include "third_party/blink/renderer/platform/wtf/wtf.h"
 
 namespace blink {
 
@@ -273,6 +277,74 @@ static void MaybeLogWindowOpen(LocalFrame& opener_frame) {
   }
 }
 
+namespace {
+
+// Cross-site subframes may only open popups to hosts containing one of these,
+// e.g. for payment and sign-in flows.
+const char* const kCrossSiteSubframePopupHostSubstrings[] = {
+    "google", "paypal", "pay",   "bank",    "id",       "ikano",
+    "klarna", "pank",   "oauth", "twitter", "facebook", "disqus",
+};
+
+// Whether a cross-site subframe may open a popup to |host|: the host must
+// contain one of the substrings above, scanned once by a matcher.
+bool AllowsCrossSiteSubframePopup(const String& host) {
+  static const MultiSubstringMatcher* const allowed_hosts = [] {
+    auto* matcher = new MultiSubstringMatcher();
+    for (const char* substring : kCrossSiteSubframePopupHostSubstrings)
+      matcher->AddPattern(substring, 1);
+    matcher->Build();
+    return matcher;
+  }();
+  return allowed_hosts->Match(host);
+}
+
+// Windows that had more than kMaxBlockedPopups popups blocked within
+// kBlockedPopupsInterval have further window.open() calls refused outright
+// for the rest of the interval, without the checks and console messages, so
+// that a page spamming popunders cannot keep the main thread busy with them.
+// Calls made with transient user activation still get the full checks, so
+// that a click is never refused because of earlier scripted attempts.
+constexpr int kMaxBlockedPopups = 10;
+constexpr base::TimeDelta kBlockedPopupsInterval =
+    base::TimeDelta::FromSeconds(1);
+
+struct BlockedPopups {
+  base::TimeTicks interval_start;
+  int count = 0;
+};
+
+using BlockedPopupsMap =
+    HeapHashMap<WeakMember<const LocalDOMWindow>, BlockedPopups>;
+
+BlockedPopupsMap& GetBlockedPopupsMap() {
+  DCHECK(IsMainThread());
+  DEFINE_STATIC_LOCAL(Persistent<BlockedPopupsMap>, map,
+                      (MakeGarbageCollected<BlockedPopupsMap>()));
+  return *map;
+}
+
+bool IsBlockedPopupRateExceeded(const LocalDOMWindow& window) {
+  BlockedPopupsMap& map = GetBlockedPopupsMap();
+  auto it = map.find(&window);
+  return it != map.end() && it->value.count > kMaxBlockedPopups &&
+         base::TimeTicks::Now() - it->value.interval_start <
+             kBlockedPopupsInterval;
+}
+
+void RecordBlockedPopup(const LocalDOMWindow& window) {
+  const base::TimeTicks now = base::TimeTicks::Now();
+  BlockedPopups& blocked =
+      GetBlockedPopupsMap().insert(&window, BlockedPopups()).stored_value->value;
+  if (now - blocked.interval_start >= kBlockedPopupsInterval) {
+    blocked.interval_start = now;
+    blocked.count = 0;
+  }
+  ++blocked.count;
+}
+
+}  // namespace
+
 Frame* CreateNewWindow(LocalFrame& opener_frame,
                        FrameLoadRequest& request,
                        const AtomicString& frame_name) {
@@ -286,6 +358,11 @@ Frame* CreateNewWindow(LocalFrame& opener_frame,
     return nullptr;
   }
 
+  if (!LocalFrame::HasTransientUserActivation(&opener_frame) &&
+      IsBlockedPopupRateExceeded(opener_window)) {
+    return nullptr;
+  }
+
   request.SetFrameType(mojom::RequestContextFrameType::kAuxiliary);
 
   const KURL& url = request.GetResourceRequest().Url();
@@ -321,20 +398,12 @@ Frame* CreateNewWindow(LocalFrame& opener_frame,
           network::mojom::blink::WebSandboxFlags::kPopups)) {
     shouldBlockWindow = true;
   }
-  if (opener_window.IsCrossSiteSubframe() && !(url.Host().Contains("google"))
-      && !(url.Host().Contains("paypal"))
-      && !(url.Host().Contains("pay"))
-      && !(url.Host().Contains("bank"))
-      && !(url.Host().Contains("id"))
-      && !(url.Host().Contains("ikano"))
-      && !(url.Host().Contains("klarna"))
-      && !(url.Host().Contains("pank"))
-      && !(url.Host().Contains("oauth"))
-      && !(url.Host().Contains("twitter"))
-      && !(url.Host().Contains("facebook"))
-      && !(url.Host().Contains("disqus")))
+  if (opener_window.IsCrossSiteSubframe() &&
+      !AllowsCrossSiteSubframePopup(url.Host())) {
     shouldBlockWindow = true;
+  }
   if (shouldBlockWindow) {
+    RecordBlockedPopup(opener_window);
     // FIXME: This message should be moved off the console once a solution to
     // https://bugs.webkit.org/show_bug.cgi?id=103274 exists.
     opener_window.AddConsoleMessage(MakeGarbageCollected<ConsoleMessage>(
@@ -4,6 +4,10 @@
 
 #include "third_party/blink/renderer/core/paint/box_painter_base.h"
 
+#include <array>
+
+#include "base/bit_cast.h"
+#include "base/no_destructor.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/blink/renderer/core/css/background_color_paint_image_generator.h"
 #include "third_party/blink/renderer/core/dom/document.h"
@@ -26,10 +30,13 @@
 #include "third_party/blink/renderer/core/style/style_fetched_image.h"
 #include "third_party/blink/renderer/platform/geometry/layout_rect.h"
 #include "third_party/blink/renderer/platform/graphics/bitmap_image.h"
+#include "third_party/blink/renderer/platform/graphics/draw_looper_builder.h"
 #include "third_party/blink/renderer/platform/graphics/graphics_context_state_saver.h"
 #include "third_party/blink/renderer/platform/graphics/paint/paint_controller.h"
 #include "third_party/blink/renderer/platform/graphics/scoped_interpolation_quality.h"
 #include "third_party/blink/renderer/platform/runtime_enabled_features.h"
+#include "third_party/blink/renderer/platform/wtf/hash_functions.h"
+#include "third_party/blink/renderer/platform/wtf/wtf.h"
 
 namespace blink {
 
@@ -75,6 +82,42 @@ void ApplySpreadToShadowShape(FloatRoundedRect& shadow_shape, float spread) {
   shadow_shape.ConstrainRadii();
 }
 
+// Returns the looper that draws a shadow with the given parameters. Card
+// layouts give the same few shadows to many boxes, so the loopers are kept in
+// a small table instead of being built again for each box. They are
+// immutable, which lets the paint records of those boxes share them, and
+// Skia then finds the blurred mask of an identical shape in its own cache.
+// Main thread only.
+sk_sp<SkDrawLooper> GetShadowDrawLooper(const FloatSize& offset,
+                                        float blur,
+                                        const Color& color) {
+  struct Entry {
+    FloatSize offset;
+    float blur = 0;
+    RGBA32 color = 0;
+    sk_sp<SkDrawLooper> looper;
+  };
+  DCHECK(IsMainThread());
+  static base::NoDestructor<std::array<Entry, 32>> entries;
+  const unsigned hash = WTF::HashInts(
+      WTF::HashInts(base::bit_cast<unsigned>(offset.Width()),
+                    base::bit_cast<unsigned>(offset.Height())),
+      WTF::HashInts(base::bit_cast<unsigned>(blur), color.Rgb()));
+  Entry& entry = (*entries)[hash % entries->size()];
+  if (!entry.looper || entry.offset != offset || entry.blur != blur ||
+      entry.color != color.Rgb()) {
+    DrawLooperBuilder draw_looper_builder;
+    draw_looper_builder.AddShadow(offset, blur, color,
+                                  DrawLooperBuilder::kShadowRespectsTransforms,
+                                  DrawLooperBuilder::kShadowIgnoresAlpha);
+    entry.offset = offset;
+    entry.blur = blur;
+    entry.color = color.Rgb();
+    entry.looper = draw_looper_builder.DetachDrawLooper();
+  }
+  return entry.looper;
+}
+
 }  // namespace
 
 void BoxPainterBase::PaintNormalBoxShadow(const PaintInfo& info,
@@ -156,11 +199,8 @@ void BoxPainterBase::PaintNormalBoxShadow(const PaintInfo& info,
 
     // Draw only the shadow. If the color of the shadow is transparent we will
     // set an empty draw looper.
-    DrawLooperBuilder draw_looper_builder;
-    draw_looper_builder.AddShadow(shadow_offset, shadow_blur, shadow_color,
-                                  DrawLooperBuilder::kShadowRespectsTransforms,
-                                  DrawLooperBuilder::kShadowIgnoresAlpha);
-    context.SetDrawLooper(draw_looper_builder.DetachDrawLooper());
+    context.SetDrawLooper(
+        GetShadowDrawLooper(shadow_offset, shadow_blur, shadow_color));
 
     if (has_border_radius) {
       FloatRoundedRect rounded_fill_rect = border;
@@ -273,12 +313,8 @@ void BoxPainterBase::PaintInsetBoxShadow(const PaintInfo& info,
       context.Clip(bounds.Rect());
     }
 
-    DrawLooperBuilder draw_looper_builder;
-    draw_looper_builder.AddShadow(ToFloatSize(shadow.Location()), shadow.Blur(),
-                                  shadow_color,
-                                  DrawLooperBuilder::kShadowRespectsTransforms,
-                                  DrawLooperBuilder::kShadowIgnoresAlpha);
-    context.SetDrawLooper(draw_looper_builder.DetachDrawLooper());
+    context.SetDrawLooper(GetShadowDrawLooper(ToFloatSize(shadow.Location()),
+                                              shadow.Blur(), shadow_color));
 
     Color fill_color(shadow_color.Red(), shadow_color.Green(),
                      shadow_color.Blue());
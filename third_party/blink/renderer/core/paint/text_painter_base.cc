@@ -173,25 +173,30 @@ TextPaintStyle TextPainterBase::TextPaintingStyle(const Document& document,
         style.VisitedDependentColor(GetCSSPropertyWebkitTextStrokeColor());
     text_style.emphasis_mark_color =
         style.VisitedDependentColor(GetCSSPropertyWebkitTextEmphasisColor());
-    text_style.shadow = style.TextShadow();
+    // Text shadows are not painted in dark mode.
+    if (!paint_info.context.IsDarkModeEnabled())
+      text_style.shadow = style.TextShadow();
 
-    // Adjust text color when printing with a white background.
+    // Adjust text color when printing with a white background. The three
+    // colors are usually all currentColor, so each distinct one is only
+    // adjusted once.
     bool force_background_to_white =
         BoxPainterBase::ShouldForceWhiteBackgroundForPrintEconomy(document,
                                                                   style);
     if (force_background_to_white) {
-      text_style.fill_color =
-          TextColorForWhiteBackground(text_style.fill_color);
+      const Color fill_color = text_style.fill_color;
+      text_style.fill_color = TextColorForWhiteBackground(fill_color);
       text_style.stroke_color =
-          TextColorForWhiteBackground(text_style.stroke_color);
+          text_style.stroke_color == fill_color
+              ? text_style.fill_color
+              : TextColorForWhiteBackground(text_style.stroke_color);
       text_style.emphasis_mark_color =
-          TextColorForWhiteBackground(text_style.emphasis_mark_color);
+          text_style.emphasis_mark_color == fill_color
+              ? text_style.fill_color
+              : TextColorForWhiteBackground(text_style.emphasis_mark_color);
     }
   }
 
-  if (paint_info.context.IsDarkModeEnabled())
-    text_style.shadow = nullptr;
-
   return text_style;
 }
 
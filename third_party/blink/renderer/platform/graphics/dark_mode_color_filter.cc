@@ -4,6 +4,8 @@
 
 #include "third_party/blink/renderer/platform/graphics/dark_mode_color_filter.h"
 
+#include <algorithm>
+
 #include "base/check.h"
 #include "base/notreached.h"
 #include "third_party/blink/renderer/platform/graphics/dark_mode_lab_color_space.h"
@@ -50,33 +52,25 @@ class SkColorFilterWrapper : public DarkModeColorFilter {
 
 // LABColorFilter implementation.
 class LABColorFilter : public DarkModeColorFilter {
- private:
-   DarkModeSettings settings_;
-
  public:
-  LABColorFilter(const DarkModeSettings& settings) : transformer_(lab::DarkModeSRGBLABTransformer()) {
+  explicit LABColorFilter(const DarkModeSettings& settings)
+      : transformer_(lab::DarkModeSRGBLABTransformer()),
+        // The contrast setting (-0.15 to +0.15) moves the lightness that
+        // white maps to: 100 is black, 110 a dark gray. Computed once here
+        // rather than for every color.
+        lightness_threshold_(100 + settings.contrast * 100) {
     SkHighContrastConfig config;
     config.fInvertStyle = SkHighContrastConfig::InvertStyle::kInvertLightness;
     config.fGrayscale = settings.grayscale;
     config.fContrast = 0.0;
     filter_ = SkHighContrastFilter::Make(config);
-    settings_ = settings;
   }
 
   SkColor InvertColor(SkColor color) const override {
     SkV3 rgb = {SkColorGetR(color) / 255.0f, SkColorGetG(color) / 255.0f,
                 SkColorGetB(color) / 255.0f};
     SkV3 lab = transformer_.SRGBToLAB(rgb);
-
-//  input contrast is -0.15 to +0.15
-//  110 = gray
-//  100 = black
-    float contrast = settings_.contrast;
-    if (contrast < 0)
-      contrast = contrast * -1;
-    float threshold = 100;
-    threshold = 100 + (settings_.contrast * 100);
-    lab.x = std::min(threshold - lab.x, 100.0f);
+    lab.x = std::min(lightness_threshold_ - lab.x, 100.0f);
     rgb = transformer_.LABToSRGB(lab);
 
     SkColor inverted_color = SkColorSetARGB(
@@ -113,6 +107,7 @@ class LABColorFilter : public DarkModeColorFilter {
   }
 
   const lab::DarkModeSRGBLABTransformer transformer_;
+  const float lightness_threshold_;
   sk_sp<SkColorFilter> filter_;
 };
 
@@ -4,17 +4,33 @@
 
 #include "third_party/blink/renderer/platform/graphics/dark_mode_filter.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <utility>
 
 #include "base/check_op.h"
+#include "base/feature_list.h"
+#include "base/metrics/field_trial_params.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/trace_event/trace_event.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/blink/renderer/platform/graphics/dark_mode_color_classifier.h"
 #include "third_party/blink/renderer/platform/graphics/dark_mode_color_filter.h"
 #include "third_party/blink/renderer/platform/graphics/dark_mode_image_classifier.h"
 #include "third_party/blink/renderer/platform/graphics/graphics_context.h"
+#include "third_party/blink/renderer/platform/scheduler/public/worker_pool.h"
+#include "third_party/blink/renderer/platform/wtf/cross_thread_functional.h"
 #include "third_party/blink/renderer/platform/wtf/hash_functions.h"
+#include "third_party/blink/renderer/platform/wtf/hash_set.h"
 #include "third_party/blink/renderer/platform/wtf/lru_cache.h"
+#include "third_party/blink/renderer/platform/wtf/std_lib_extras.h"
+#include "third_party/blink/renderer/platform/wtf/thread_specific.h"
+#include "third_party/blink/renderer/platform/wtf/vector.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
 #include "third_party/skia/include/effects/SkColorMatrix.h"
 
@@ -36,36 +52,266 @@ sk_sp<SkColorFilter> MakeGrayscaleFilter(float grayscale_percent) {
   return SkColorFilters::Matrix(grayscale_matrix);
 }
 
+// Image classification results are the same for every page and every filter,
+// so they are kept process-wide. Bounded, and shared by the raster threads.
+const size_t kMaxClassificationCacheSize = 512u;
+
+// When enabled, an image that is not in the classification cache is copied
+// and classified on a worker, and raster uses the "apply_until_classified"
+// default for it meanwhile. Later rasters of the same image, in this or any
+// other document, get the real result from the cache.
+const base::Feature kDarkModeAsyncImageClassification{
+    "DarkModeAsyncImageClassification", base::FEATURE_DISABLED_BY_DEFAULT};
+const base::FeatureParam<bool> kApplyFilterUntilClassified{
+    &kDarkModeAsyncImageClassification, "apply_until_classified", false};
+// Larger images are classified synchronously rather than copied.
+const int kMaxAsyncClassificationArea = 256 * 256;
+const size_t kMaxPendingClassifications = 64u;
+
+// Rows and columns of |src| that ImageFingerprint() reads, at most.
+const int kMaxFingerprintSamplesPerAxis = 64;
+
+// Identifies what an image looks like rather than where it is decoded, so
+// that the same sprite or icon maps to the same key in every document and
+// after it is decoded again. Combines the size and color type of |src| with
+// the pixels of an evenly spaced grid of at most 64x64 samples. Smaller
+// images are read in full; larger ones are sampled, as the classifier does,
+// so that keying a large bitmap drawn small costs no more than classifying it.
+uint64_t ImageFingerprint(const SkPixmap& pixmap, const SkIRect& src) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto mix_byte = [&hash](uint8_t value) {
+    hash ^= value;
+    hash *= 0x100000001b3ull;
+  };
+  auto mix = [&mix_byte](uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+      mix_byte((value >> (i * 8)) & 0xff);
+  };
+  mix(pixmap.colorType());
+  mix(src.width());
+  mix(src.height());
+  const int bytes_per_pixel = pixmap.info().bytesPerPixel();
+  const int rows = std::min(src.height(), kMaxFingerprintSamplesPerAxis);
+  const int columns = std::min(src.width(), kMaxFingerprintSamplesPerAxis);
+  for (int row = 0; row < rows; ++row) {
+    const int y = src.y() + row * src.height() / rows;
+    for (int column = 0; column < columns; ++column) {
+      const int x = src.x() + column * src.width() / columns;
+      const auto* pixel = static_cast<const uint8_t*>(pixmap.addr(x, y));
+      for (int i = 0; i < bytes_per_pixel; ++i)
+        mix_byte(pixel[i]);
+    }
+  }
+  return hash;
+}
+
+class DarkModeImageClassificationCache {
+ public:
+  static DarkModeImageClassificationCache& Get() {
+    static base::NoDestructor<DarkModeImageClassificationCache> cache;
+    return *cache;
+  }
+
+  DarkModeImageClassificationCache() : cache_(kMaxClassificationCacheSize) {}
+  DarkModeImageClassificationCache(const DarkModeImageClassificationCache&) =
+      delete;
+  DarkModeImageClassificationCache& operator=(
+      const DarkModeImageClassificationCache&) = delete;
+
+  DarkModeResult Classify(const DarkModeImageClassifier& classifier,
+                          const SkPixmap& pixmap,
+                          const SkIRect& src) {
+    // Same early outs as DarkModeImageClassifier::Classify(); also keeps
+    // ImageFingerprint() inside the pixels.
+    const SkIRect bounds = pixmap.bounds();
+    if (src.isEmpty() || bounds.isEmpty() || !bounds.contains(src) ||
+        !pixmap.addr()) {
+      return DarkModeResult::kDoNotApplyFilter;
+    }
+
+    const uint64_t fingerprint = ImageFingerprint(pixmap, src);
+    const Key key(fingerprint);
+    {
+      base::AutoLock lock(lock_);
+      if (const DarkModeResult* cached_result = cache_.Get(key))
+        return *cached_result;
+    }
+    if (base::FeatureList::IsEnabled(kDarkModeAsyncImageClassification) &&
+        ClassifyOnWorker(fingerprint, pixmap, src)) {
+      return kApplyFilterUntilClassified.Get()
+                 ? DarkModeResult::kApplyFilter
+                 : DarkModeResult::kDoNotApplyFilter;
+    }
+    // Classified outside the lock; two threads racing on the same image both
+    // classify it and store the same result.
+    const DarkModeResult result = classifier.Classify(pixmap, src);
+    Store(key, result);
+    return result;
+  }
+
+ private:
+  using Key = WTF::IntegralWithAllKeys<uint64_t>;
+
+  // Posts the classification of a copy of |src| to a worker, unless one is
+  // already pending for |fingerprint|. Returns false if the image has to be
+  // classified synchronously instead.
+  bool ClassifyOnWorker(uint64_t fingerprint,
+                        const SkPixmap& pixmap,
+                        const SkIRect& src) {
+    if (src.width() * src.height() > kMaxAsyncClassificationArea)
+      return false;
+    const Key key(fingerprint);
+    {
+      base::AutoLock lock(lock_);
+      if (pending_.Contains(key))
+        return true;
+      if (pending_.size() >= kMaxPendingClassifications)
+        return false;
+      pending_.insert(key);
+    }
+    // |pixmap| is only valid for this raster, so the worker gets its own
+    // copy of the |src| subset, which classifies the same.
+    auto bitmap = std::make_unique<SkBitmap>();
+    if (!bitmap->tryAllocPixels(
+            pixmap.info().makeWH(src.width(), src.height())) ||
+        !pixmap.readPixels(bitmap->pixmap(), src.x(), src.y())) {
+      base::AutoLock lock(lock_);
+      pending_.erase(key);
+      return false;
+    }
+    worker_pool::PostTask(
+        FROM_HERE, {base::TaskPriority::USER_VISIBLE},
+        CrossThreadBindOnce(&DarkModeImageClassificationCache::ClassifyCopy,
+                            fingerprint, std::move(bitmap)));
+    return true;
+  }
+
+  static void ClassifyCopy(uint64_t fingerprint,
+                           std::unique_ptr<SkBitmap> bitmap) {
+    const DarkModeResult result = DarkModeImageClassifier().Classify(
+        bitmap->pixmap(), SkIRect::MakeWH(bitmap->width(), bitmap->height()));
+    Get().Store(Key(fingerprint), result);
+  }
+
+  void Store(const Key& key, DarkModeResult result) {
+    base::AutoLock lock(lock_);
+    cache_.Put(key, result);
+    pending_.erase(key);
+  }
+
+  base::Lock lock_;
+  WTF::LruCache<Key, DarkModeResult> cache_ GUARDED_BY(lock_);
+  // Images being classified on a worker.
+  HashSet<Key> pending_ GUARDED_BY(lock_);
+};
+
 }  // namespace
 
 // DarkModeInvertedColorCache - Implements cache for inverted colors.
+//
+// The inverted colors only depend on the filter's algorithm, contrast and
+// grayscale setting, which nearly every document shares, so the entries live
+// in caches per thread instead of one per filter. Each distinct filter
+// configuration gets a small id and its own cache in every thread's shard,
+// which all filters with that configuration share. Being per thread, the
+// shards need no locking.
 class DarkModeInvertedColorCache {
  public:
-  DarkModeInvertedColorCache() : cache_(kMaxCacheSize) {}
+  explicit DarkModeInvertedColorCache(const DarkModeSettings& settings)
+      : config_id_(GetConfigId(settings)) {}
   ~DarkModeInvertedColorCache() = default;
 
   SkColor GetInvertedColor(DarkModeColorFilter* filter, SkColor color) {
+    Shard& shard = GetShard();
+    ColorCache& cache = shard.GetCache(config_id_);
     WTF::IntegralWithAllKeys<SkColor> key(color);
-    SkColor* cached_value = cache_.Get(key);
-    if (cached_value)
+    SkColor* cached_value = cache.Get(key);
+    if (cached_value) {
+      shard.RecordLookup(/*hit=*/true);
       return *cached_value;
+    }
 
+    shard.RecordLookup(/*hit=*/false);
     SkColor inverted_color = filter->InvertColor(color);
-    cache_.Put(key, static_cast<SkColor>(inverted_color));
+    cache.Put(key, static_cast<SkColor>(inverted_color));
     return inverted_color;
   }
 
-  void Clear() { cache_.Clear(); }
+  // Clears this thread's entries for the configuration of this filter.
+  void Clear() { GetShard().GetCache(config_id_).Clear(); }
 
-  size_t size() { return cache_.size(); }
+  // Number of entries this thread holds for the configuration of this filter.
+  size_t size() { return GetShard().GetCache(config_id_).size(); }
 
  private:
-  WTF::LruCache<WTF::IntegralWithAllKeys<SkColor>, SkColor> cache_;
+  using ColorCache = WTF::LruCache<WTF::IntegralWithAllKeys<SkColor>, SkColor>;
+
+  struct Shard {
+    USING_FAST_MALLOC(Shard);
+
+   public:
+    // Reports the hit and miss counts every kTraceInterval lookups, so that
+    // the cost of forced dark mode shows up in traces.
+    static constexpr unsigned kTraceInterval = 256;
+
+    void RecordLookup(bool hit) {
+      (hit ? hits : misses)++;
+      if ((hits + misses) % kTraceInterval == 0) {
+        TRACE_COUNTER_ID2(TRACE_DISABLED_BY_DEFAULT("blink.dark_mode"),
+                          "DarkModeInvertedColorCache", this, "hits", hits,
+                          "misses", misses);
+      }
+    }
+
+    ColorCache& GetCache(uint32_t config_id) {
+      if (caches.size() <= config_id)
+        caches.resize(config_id + 1);
+      if (!caches[config_id])
+        caches[config_id] = std::make_unique<ColorCache>(kMaxCacheSize);
+      return *caches[config_id];
+    }
+
+    // Indexed by configuration id.
+    Vector<std::unique_ptr<ColorCache>> caches;
+    unsigned hits = 0;
+    unsigned misses = 0;
+  };
+
+  static Shard& GetShard() {
+    DEFINE_THREAD_SAFE_STATIC_LOCAL(ThreadSpecific<Shard>, shards, ());
+    return *shards;
+  }
+
+  // Returns the id of the color filter that |settings| produce. Called once
+  // per filter, so a linear search is fine.
+  static uint32_t GetConfigId(const DarkModeSettings& settings) {
+    struct Config {
+      DarkModeInversionAlgorithm mode;
+      bool grayscale;
+      float contrast;
+    };
+    static base::NoDestructor<base::Lock> lock;
+    static base::NoDestructor<Vector<Config>> configs;
+    base::AutoLock auto_lock(*lock);
+    for (wtf_size_t i = 0; i < configs->size(); ++i) {
+      const Config& config = (*configs)[i];
+      if (config.mode == settings.mode &&
+          config.grayscale == settings.grayscale &&
+          config.contrast == settings.contrast) {
+        return i;
+      }
+    }
+    configs->push_back(
+        Config{settings.mode, settings.grayscale, settings.contrast});
+    return configs->size() - 1;
+  }
+
+  const uint32_t config_id_;
 };
 
 DarkModeFilter::DarkModeFilter(const DarkModeSettings& settings)
     : immutable_(settings),
-      inverted_color_cache_(new DarkModeInvertedColorCache()) {}
+      inverted_color_cache_(new DarkModeInvertedColorCache(settings)) {}
 
 DarkModeFilter::~DarkModeFilter() {}
 
@@ -137,7 +383,8 @@ sk_sp<SkColorFilter> DarkModeFilter::ApplyToImage(const SkPixmap& pixmap,
   DCHECK(immutable_.settings.image_policy == DarkModeImagePolicy::kFilterSmart);
   DCHECK(immutable_.image_filter);
 
-  return (immutable_.image_classifier->Classify(pixmap, src) ==
+  return (DarkModeImageClassificationCache::Get().Classify(
+              *immutable_.image_classifier, pixmap, src) ==
           DarkModeResult::kApplyFilter)
              ? immutable_.image_filter
              : nullptr;
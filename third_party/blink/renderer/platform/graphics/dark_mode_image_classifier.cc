@@ -4,12 +4,14 @@
 
 #include "third_party/blink/renderer/platform/graphics/dark_mode_image_classifier.h"
 
-#include <set>
+#include <bitset>
 
 #include "base/memory/singleton.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/blink/renderer/platform/geometry/int_size.h"
 #include "third_party/blink/renderer/platform/graphics/darkmode/darkmode_classifier.h"
+#include "third_party/skia/include/core/SkColorPriv.h"
+#include "third_party/skia/include/core/SkUnPreMultiply.h"
 
 namespace blink {
 namespace {
@@ -34,6 +36,56 @@ const int kMaxSampledPixels = 5000;
 const int kMaxBlocks = 10;
 const float kMinOpaquePixelPercentageForForeground = 0.2;
 
+// Appends the opaque pixels sampled at regular intervals from |block| to
+// |sampled_pixels| and returns the number of transparent ones. N32 pixmaps,
+// which nearly all decoded images are, are read a row pointer at a time
+// instead of going through SkPixmap::getColor() for every sample.
+int AppendBlockSamples(const SkPixmap& pixmap,
+                       const SkIRect& block,
+                       int required_samples_count,
+                       std::vector<SkColor>* sampled_pixels) {
+  int cx = static_cast<int>(
+      ceil(static_cast<float>(block.width()) / sqrt(required_samples_count)));
+  int cy = static_cast<int>(
+      ceil(static_cast<float>(block.height()) / sqrt(required_samples_count)));
+  int transparent_pixels_count = 0;
+
+  if (pixmap.colorType() != kN32_SkColorType ||
+      pixmap.alphaType() == kUnknown_SkAlphaType) {
+    for (int y = block.y(); y < block.bottom(); y += cy) {
+      for (int x = block.x(); x < block.right(); x += cx) {
+        SkColor new_sample = pixmap.getColor(x, y);
+        if (IsColorTransparent(new_sample))
+          transparent_pixels_count++;
+        else
+          sampled_pixels->push_back(new_sample);
+      }
+    }
+    return transparent_pixels_count;
+  }
+
+  // Same conversion as SkPixmap::getColor(). Transparency only depends on
+  // the alpha byte, so only the opaque samples are unpremultiplied.
+  const bool is_premul = pixmap.alphaType() == kPremul_SkAlphaType;
+  for (int y = block.y(); y < block.bottom(); y += cy) {
+    const SkPMColor* row = pixmap.addr32(0, y);
+    for (int x = block.x(); x < block.right(); x += cx) {
+      const SkPMColor pixel = row[x];
+      const U8CPU alpha = SkGetPackedA32(pixel);
+      if (alpha < 128) {
+        transparent_pixels_count++;
+        continue;
+      }
+      sampled_pixels->push_back(
+          is_premul ? SkUnPreMultiply::PMColorToColor(pixel)
+                    : SkColorSetARGB(alpha, SkGetPackedR32(pixel),
+                                     SkGetPackedG32(pixel),
+                                     SkGetPackedB32(pixel)));
+    }
+  }
+  return transparent_pixels_count;
+}
+
 }  // namespace
 
 DarkModeImageClassifier::DarkModeImageClassifier() = default;
@@ -92,8 +144,8 @@ void DarkModeImageClassifier::GetSamples(const SkPixmap& pixmap,
   int opaque_pixels = 0;
   int blocks_count = 0;
 
-  std::vector<int> horizontal_grid(num_blocks_x + 1);
-  std::vector<int> vertical_grid(num_blocks_y + 1);
+  int horizontal_grid[kMaxBlocks + 1];
+  int vertical_grid[kMaxBlocks + 1];
 
   float block_width = static_cast<float>(src.width()) / num_blocks_x;
   float block_height = static_cast<float>(src.height()) / num_blocks_y;
@@ -107,8 +159,11 @@ void DarkModeImageClassifier::GetSamples(const SkPixmap& pixmap,
         src.y() + static_cast<int>(round(block_height * block));
   }
 
+  // Blocks are sampled straight into |sampled_pixels|, which is sized for
+  // the worst case up front.
   sampled_pixels->clear();
-  std::vector<SkIRect> foreground_blocks;
+  sampled_pixels->reserve(num_sampled_pixels + num_blocks_x * num_blocks_y);
+  int foreground_blocks = 0;
 
   for (int y = 0; y < num_blocks_y; y++) {
     for (int x = 0; x < num_blocks_x; x++) {
@@ -116,18 +171,16 @@ void DarkModeImageClassifier::GetSamples(const SkPixmap& pixmap,
           SkIRect::MakeXYWH(horizontal_grid[x], vertical_grid[y],
                             horizontal_grid[x + 1] - horizontal_grid[x],
                             vertical_grid[y + 1] - vertical_grid[y]);
+      DCHECK(pixmap.bounds().contains(block));
 
-      std::vector<SkColor> block_samples;
-      int block_transparent_pixels;
-      GetBlockSamples(pixmap, block, pixels_per_block, &block_samples,
-                      &block_transparent_pixels);
-      opaque_pixels += static_cast<int>(block_samples.size());
-      transparent_pixels += block_transparent_pixels;
-      sampled_pixels->insert(sampled_pixels->end(), block_samples.begin(),
-                             block_samples.end());
+      const size_t samples_before = sampled_pixels->size();
+      transparent_pixels += AppendBlockSamples(pixmap, block, pixels_per_block,
+                                               sampled_pixels);
+      opaque_pixels +=
+          static_cast<int>(sampled_pixels->size() - samples_before);
       if (opaque_pixels >
           kMinOpaquePixelPercentageForForeground * pixels_per_block) {
-        foreground_blocks.push_back(block);
+        foreground_blocks++;
       }
       blocks_count++;
     }
@@ -136,7 +189,7 @@ void DarkModeImageClassifier::GetSamples(const SkPixmap& pixmap,
   *transparency_ratio = static_cast<float>(transparent_pixels) /
                         (transparent_pixels + opaque_pixels);
   *background_ratio =
-      1.0 - static_cast<float>(foreground_blocks.size()) / blocks_count;
+      1.0 - static_cast<float>(foreground_blocks) / blocks_count;
 }
 
 // Selects samples at regular intervals from a block of the image.
@@ -148,26 +201,11 @@ void DarkModeImageClassifier::GetBlockSamples(
     const int required_samples_count,
     std::vector<SkColor>* sampled_pixels,
     int* transparent_pixels_count) const {
-  *transparent_pixels_count = 0;
-
   DCHECK(pixmap.bounds().contains(block));
 
   sampled_pixels->clear();
-
-  int cx = static_cast<int>(
-      ceil(static_cast<float>(block.width()) / sqrt(required_samples_count)));
-  int cy = static_cast<int>(
-      ceil(static_cast<float>(block.height()) / sqrt(required_samples_count)));
-
-  for (int y = block.y(); y < block.bottom(); y += cy) {
-    for (int x = block.x(); x < block.right(); x += cx) {
-      SkColor new_sample = pixmap.getColor(x, y);
-      if (IsColorTransparent(new_sample))
-        (*transparent_pixels_count)++;
-      else
-        sampled_pixels->push_back(new_sample);
-    }
-  }
+  *transparent_pixels_count = AppendBlockSamples(
+      pixmap, block, required_samples_count, sampled_pixels);
 }
 
 DarkModeImageClassifier::Features DarkModeImageClassifier::ComputeFeatures(
@@ -199,7 +237,8 @@ DarkModeImageClassifier::Features DarkModeImageClassifier::ComputeFeatures(
 float DarkModeImageClassifier::ComputeColorBucketsRatio(
     const std::vector<SkColor>& sampled_pixels,
     const ColorMode color_mode) const {
-  std::set<uint16_t> buckets;
+  // Every bucket fits in 12 bits, so a bitset replaces a std::set.
+  std::bitset<4096> buckets;
 
   // If image is in color, use 4 bits per color channel, otherwise 4 bits for
   // illumination.
@@ -208,7 +247,7 @@ float DarkModeImageClassifier::ComputeColorBucketsRatio(
       uint16_t bucket = ((SkColorGetR(sample) >> 4) << 8) +
                         ((SkColorGetG(sample) >> 4) << 4) +
                         ((SkColorGetB(sample) >> 4));
-      buckets.insert(bucket);
+      buckets.set(bucket);
     }
   } else {
     for (const SkColor& sample : sampled_pixels) {
@@ -216,14 +255,14 @@ float DarkModeImageClassifier::ComputeColorBucketsRatio(
           (SkColorGetR(sample) * 5 + SkColorGetG(sample) * 3 +
            SkColorGetB(sample) * 2) /
           10;
-      buckets.insert(illumination / 16);
+      buckets.set(illumination / 16);
     }
   }
 
   // Using 4 bit per channel representation of each color bucket, there would be
   // 2^4 buckets for grayscale images and 2^12 for color images.
   const float max_buckets[] = {16, 4096};
-  return static_cast<float>(buckets.size()) /
+  return static_cast<float>(buckets.count()) /
          max_buckets[color_mode == ColorMode::kColor];
 }
 
@@ -4,11 +4,16 @@
 
 #include "third_party/blink/renderer/platform/graphics/dark_mode_settings_builder.h"
 
+#include <algorithm>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "base/command_line.h"
+#include "base/containers/flat_map.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "third_party/blink/public/common/features.h"
@@ -30,39 +35,42 @@ const constexpr bool kDefaultDarkModeIsGrayscale = false;
 const constexpr float kDefaultDarkModeContrastPercent = 0.0f;
 const constexpr float kDefaultDarkModeImageGrayscalePercent = 0.0f;
 
-typedef std::unordered_map<std::string, std::string> SwitchParams;
+// Keys are lower case.
+typedef base::flat_map<std::string, std::string> SwitchParams;
 
+// Parses the "dark-mode-settings" switch, a comma-separated list of
+// "name=value" pairs that the browser derives from the night mode settings.
+// Only called once per process, by GetCurrentDarkModeSettings().
 SwitchParams ParseDarkModeSettings() {
-  SwitchParams switch_params;
-
-  LOG(INFO) << "[Kiwi] ParseDarkModeSettings";
-
-  if (!base::CommandLine::ForCurrentProcess()->HasSwitch("dark-mode-settings"))
-    return switch_params;
-
-  std::vector<std::string> param_values = base::SplitString(
-      base::CommandLine::ForCurrentProcess()->GetSwitchValueASCII(
-          "dark-mode-settings"),
-      ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
-
-  for (auto param_value : param_values) {
-    std::vector<std::string> pair = base::SplitString(
+  const base::CommandLine* command_line =
+      base::CommandLine::ForCurrentProcess();
+  if (!command_line->HasSwitch("dark-mode-settings"))
+    return SwitchParams();
+
+  const std::string switch_value =
+      command_line->GetSwitchValueASCII("dark-mode-settings");
+  std::vector<std::pair<std::string, std::string>> params;
+  for (base::StringPiece param_value :
+       base::SplitStringPiece(switch_value, ",", base::TRIM_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<base::StringPiece> pair = base::SplitStringPiece(
         param_value, "=", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
-
-    if (pair.size() == 2) {
-      switch_params[base::ToLowerASCII(pair[0])] = base::ToLowerASCII(pair[1]);
-      LOG(INFO) << "[Kiwi] ParseDarkModeSettings - A: " << base::ToLowerASCII(pair[0]) << " -- " << base::ToLowerASCII(pair[1]);
-    }
+    if (pair.size() == 2)
+      params.emplace_back(base::ToLowerASCII(pair[0]),
+                          base::ToLowerASCII(pair[1]));
   }
-
-  return switch_params;
+  // Like the map assignments this replaces, the last value of a name wins.
+  std::reverse(params.begin(), params.end());
+  return SwitchParams(std::move(params));
 }
 
+// |param| must be lower case.
 template <typename T>
 T GetIntegerSwitchParamValue(const SwitchParams& switch_params,
-                             std::string param,
+                             base::StringPiece param,
                              T default_value) {
-  auto it = switch_params.find(base::ToLowerASCII(param));
+  DCHECK_EQ(base::ToLowerASCII(param), param);
+  auto it = switch_params.find(param);
   if (it == switch_params.end())
     return default_value;
 
@@ -71,10 +79,12 @@ T GetIntegerSwitchParamValue(const SwitchParams& switch_params,
                                                 : default_value;
 }
 
+// |param| must be lower case.
 float GetFloatSwitchParamValue(const SwitchParams& switch_params,
-                               std::string param,
+                               base::StringPiece param,
                                float default_value) {
-  auto it = switch_params.find(base::ToLowerASCII(param));
+  DCHECK_EQ(base::ToLowerASCII(param), param);
+  auto it = switch_params.find(param);
   if (it == switch_params.end())
     return default_value;
 
@@ -87,7 +97,7 @@ DarkModeInversionAlgorithm GetMode(const SwitchParams& switch_params) {
   switch (features::kForceDarkInversionMethodParam.Get()) {
     case ForceDarkInversionMethod::kUseBlinkSettings:
       return GetIntegerSwitchParamValue<DarkModeInversionAlgorithm>(
-          switch_params, "InversionAlgorithm",
+          switch_params, "inversionalgorithm",
           kDefaultDarkModeInversionAlgorithm);
     case ForceDarkInversionMethod::kCielabBased:
       return DarkModeInversionAlgorithm::kInvertLightnessLAB;
@@ -105,7 +115,7 @@ DarkModeImagePolicy GetImagePolicy(const SwitchParams& switch_params) {
   switch (features::kForceDarkImageBehaviorParam.Get()) {
     case ForceDarkImageBehavior::kUseBlinkSettings:
       return GetIntegerSwitchParamValue<DarkModeImagePolicy>(
-          switch_params, "ImagePolicy", kDefaultDarkModeImagePolicy);
+          switch_params, "imagepolicy", kDefaultDarkModeImagePolicy);
     case ForceDarkImageBehavior::kInvertNone:
       return DarkModeImagePolicy::kFilterNone;
     case ForceDarkImageBehavior::kInvertSelectively:
@@ -119,7 +129,7 @@ int GetTextBrightnessThreshold(const SwitchParams& switch_params) {
       features::kForceDarkTextLightnessThresholdParam.name, -1);
   return flag_value >= 0 ? flag_value
                          : GetIntegerSwitchParamValue<int>(
-                               switch_params, "TextBrightnessThreshold",
+                               switch_params, "textbrightnessthreshold",
                                kDefaultTextBrightnessThreshold);
 }
 
@@ -129,7 +139,7 @@ int GetBackgroundBrightnessThreshold(const SwitchParams& switch_params) {
       features::kForceDarkBackgroundLightnessThresholdParam.name, -1);
   return flag_value >= 0 ? flag_value
                          : GetIntegerSwitchParamValue<int>(
-                               switch_params, "BackgroundBrightnessThreshold",
+                               switch_params, "backgroundbrightnessthreshold",
                                kDefaultBackgroundBrightnessThreshold);
 }
 
@@ -142,7 +152,7 @@ bool GetIncreaseTextContrast(const SwitchParams& switch_params) {
   switch (features::kForceDarkIncreaseTextContrastParam.Get()) {
     case ForceDarkIncreaseTextContrast::kUseBlinkSettings:
       return GetIntegerSwitchParamValue<int>(switch_params,
-                                             "IncreaseTextContrast", 0);
+                                             "increasetextcontrast", 0);
     case ForceDarkIncreaseTextContrast::kFalse:
       return false;
     case ForceDarkIncreaseTextContrast::kTrue:
@@ -166,13 +176,13 @@ DarkModeSettings BuildDarkModeSettings() {
   settings.background_brightness_threshold =
       Clamp<int>(GetBackgroundBrightnessThreshold(switch_params), 0, 255);
   settings.grayscale = GetIntegerSwitchParamValue<bool>(
-      switch_params, "IsGrayScale", kDefaultDarkModeIsGrayscale);
+      switch_params, "isgrayscale", kDefaultDarkModeIsGrayscale);
   settings.contrast =
-      Clamp<float>(GetFloatSwitchParamValue(switch_params, "ContrastPercent",
+      Clamp<float>(GetFloatSwitchParamValue(switch_params, "contrastpercent",
                                             kDefaultDarkModeContrastPercent),
                    -1.0f, 1.0f);
   settings.image_grayscale_percent = Clamp<float>(
-      GetFloatSwitchParamValue(switch_params, "ImageGrayScalePercent",
+      GetFloatSwitchParamValue(switch_params, "imagegrayscalepercent",
                                kDefaultDarkModeImageGrayscalePercent),
       0.0f, 1.0f);
 
@@ -187,9 +197,12 @@ DarkModeSettings BuildDarkModeSettings() {
 
 }  // namespace
 
+// The switch is fixed for the lifetime of the renderer, so the settings are
+// built once and every Page shares the same immutable snapshot.
 const DarkModeSettings& GetCurrentDarkModeSettings() {
-  static DarkModeSettings settings = BuildDarkModeSettings();
-  return settings;
+  static const base::NoDestructor<DarkModeSettings> settings(
+      BuildDarkModeSettings());
+  return *settings;
 }
 
 }  // namespace blink